@@ -14,6 +14,7 @@ public class AsyncFutures : ModuleRules
 		PublicDependencyModuleNames.AddRange(new string[] {
 			"Core",
 			"CoreUObject",
+			"TraceLog",
 		});
 	}
 }
\ No newline at end of file
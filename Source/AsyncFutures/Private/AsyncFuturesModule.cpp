@@ -1,9 +1,23 @@
 // Copyright Dominic Curry. All Rights Reserved.
 #include "AsyncFuturesModule.h"
 
+// Module Includes
+#include "Scheduler.h"
+
+DEFINE_LOG_CATEGORY(LogAsyncFutures);
+
 class FAsyncFutures : public IAsyncFutures
 {
+public:
+	virtual void ShutdownModule() override
+	{
+		UE::Tasks::Private::StopDedicatedThreads();
+	}
 
+	virtual UE::Tasks::FAsyncFuturesMetrics GetMetrics() const override
+	{
+		return UE::Tasks::Private::GatherMetrics();
+	}
 };
 
 IMPLEMENT_MODULE(FAsyncFutures, AsyncFutures)
\ No newline at end of file
@@ -0,0 +1,129 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include "CallSite.h"
+
+// Engine Includes
+#include "Containers/Map.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/OutputDevice.h"
+#include "Misc/ScopeLock.h"
+
+namespace UE::Tasks
+{
+	namespace Private
+	{
+		static TAutoConsoleVariable<int32> CVarCallSiteSampleRate(
+			TEXT("AsyncFutures.CallSites.SampleRate"),
+			0,
+			TEXT("Records the cost of one in every N continuations against the Then or Async call that created it. 0 disables recording, 1 records every continuation."),
+			ECVF_Default);
+
+		struct FCallSiteTotals
+		{
+			uint64 Count = 0;
+			uint64 CpuCycles = 0;
+			uint64 WaitCycles = 0;
+		};
+
+		class FCallSiteRegistry
+		{
+		public:
+			static FCallSiteRegistry& Get()
+			{
+				static FCallSiteRegistry Registry;
+				return Registry;
+			}
+
+			void Record(const FCallSite& CallSite, const int32 Weight, const uint64 CpuCycles, const uint64 WaitCycles)
+			{
+				FScopeLock Lock(&CriticalSection);
+				FCallSiteTotals& Totals = Sites.FindOrAdd(TPair<const ANSICHAR*, int32>(CallSite.File, CallSite.Line));
+				Totals.Count += Weight;
+				Totals.CpuCycles += CpuCycles * Weight;
+				Totals.WaitCycles += WaitCycles * Weight;
+			}
+
+			TArray<FCallSiteStats> GetReport()
+			{
+				TArray<FCallSiteStats> Report;
+				{
+					FScopeLock Lock(&CriticalSection);
+					for (const TPair<TPair<const ANSICHAR*, int32>, FCallSiteTotals>& Site : Sites)
+					{
+						//The same file can be seen through different pointers from different modules
+						const FString File = ANSI_TO_TCHAR(Site.Key.Key);
+						FCallSiteStats* Stats = Report.FindByPredicate([&File, &Site](const FCallSiteStats& Existing) { return Existing.Line == Site.Key.Value && Existing.File == File; });
+						if (Stats == nullptr)
+						{
+							Stats = &Report.AddDefaulted_GetRef();
+							Stats->File = File;
+							Stats->Line = Site.Key.Value;
+						}
+						Stats->Count += Site.Value.Count;
+						Stats->CpuSeconds += FPlatformTime::ToSeconds64(Site.Value.CpuCycles);
+						Stats->WaitSeconds += FPlatformTime::ToSeconds64(Site.Value.WaitCycles);
+					}
+				}
+
+				Report.Sort([](const FCallSiteStats& A, const FCallSiteStats& B) { return A.CpuSeconds > B.CpuSeconds; });
+				return Report;
+			}
+
+			void Reset()
+			{
+				FScopeLock Lock(&CriticalSection);
+				Sites.Reset();
+			}
+
+		private:
+			FCriticalSection CriticalSection;
+			TMap<TPair<const ANSICHAR*, int32>, FCallSiteTotals> Sites;
+		};
+
+		static FAutoConsoleCommandWithWorldArgsAndOutputDevice CallSitesCommand(
+			TEXT("AsyncFutures.CallSites"),
+			TEXT("Prints the call sites whose continuations have used the most CPU time. Optionally takes how many to print, 20 by default. Needs AsyncFutures.CallSites.SampleRate to be set."),
+			FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld*, FOutputDevice& Output)
+			{
+				const int32 MaxSites = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 20;
+				const TArray<FCallSiteStats> Report = GetCallSiteReport();
+				Output.Logf(TEXT("%-12s %-12s %-10s %s"), TEXT("CPU (ms)"), TEXT("Wait (ms)"), TEXT("Count"), TEXT("Call site"));
+				for (int32 Index = 0; Index < FMath::Min(MaxSites, Report.Num()); ++Index)
+				{
+					const FCallSiteStats& Stats = Report[Index];
+					Output.Logf(TEXT("%-12.2f %-12.2f %-10llu %s(%d)"), Stats.CpuSeconds * 1000.0, Stats.WaitSeconds * 1000.0, Stats.Count, *Stats.File, Stats.Line);
+				}
+			}));
+
+		static FAutoConsoleCommand ResetCallSitesCommand(
+			TEXT("AsyncFutures.CallSites.Reset"),
+			TEXT("Clears the costs recorded against call sites."),
+			FConsoleCommandDelegate::CreateStatic(&ResetCallSiteReport));
+
+		int32 SampleCallSite()
+		{
+			const int32 SampleRate = CVarCallSiteSampleRate.GetValueOnAnyThread();
+			if (SampleRate <= 0)
+			{
+				return 0;
+			}
+
+			static thread_local uint32 Counter = 0;
+			return (++Counter % (uint32)SampleRate) == 0 ? SampleRate : 0;
+		}
+
+		void RecordCallSite(const FCallSite& CallSite, const int32 Weight, const uint64 ReadyCycles, const uint64 StartCycles, const uint64 EndCycles)
+		{
+			FCallSiteRegistry::Get().Record(CallSite, Weight, EndCycles - StartCycles, StartCycles > ReadyCycles ? StartCycles - ReadyCycles : 0);
+		}
+	}
+
+	TArray<FCallSiteStats> GetCallSiteReport()
+	{
+		return Private::FCallSiteRegistry::Get().GetReport();
+	}
+
+	void ResetCallSiteReport()
+	{
+		Private::FCallSiteRegistry::Get().Reset();
+	}
+}
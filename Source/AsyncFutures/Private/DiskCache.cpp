@@ -0,0 +1,137 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include "DiskCache.h"
+
+// Engine Includes
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Guid.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+
+namespace UE::Tasks
+{
+	namespace Private
+	{
+		struct FDiskCacheEntryHeader
+		{
+			static constexpr uint32 ExpectedMagic = 0x41464443; //AFDC
+
+			uint32 Magic;
+			uint32 Crc;
+			uint64 PayloadSize;
+		};
+
+		static bool ReadDiskCacheEntry(TArrayView<const uint8> Bytes, TFunctionRef<bool(TArrayView<const uint8>)> Reader)
+		{
+			if (Bytes.Num() < (int32)sizeof(FDiskCacheEntryHeader))
+			{
+				return false;
+			}
+
+			FDiskCacheEntryHeader Header;
+			FMemory::Memcpy(&Header, Bytes.GetData(), sizeof(FDiskCacheEntryHeader));
+			const TArrayView<const uint8> Payload = Bytes.RightChop(sizeof(FDiskCacheEntryHeader));
+			if (Header.Magic != FDiskCacheEntryHeader::ExpectedMagic || Header.PayloadSize != (uint64)Payload.Num() || Header.Crc != FCrc::MemCrc32(Payload.GetData(), Payload.Num()))
+			{
+				return false; //Truncated or corrupt, treat it as a miss so it gets recomputed
+			}
+			return Reader(Payload);
+		}
+	}
+
+	FAsyncDiskCache::FAsyncDiskCache(const FString& InDirectory, const FString& InVersion)
+		: Directory(InDirectory)
+		, Version(InVersion)
+	{
+	}
+
+	FString FAsyncDiskCache::GetPath(const FString& Key) const
+	{
+		FSHA1 Hash;
+		const FTCHARToUTF8 VersionUtf8(*Version);
+		const FTCHARToUTF8 KeyUtf8(*Key);
+		Hash.Update((const uint8*)VersionUtf8.Get(), VersionUtf8.Length());
+		Hash.Update((const uint8*)"\0", 1);
+		Hash.Update((const uint8*)KeyUtf8.Get(), KeyUtf8.Length());
+		Hash.Final();
+
+		FSHAHash Digest;
+		Hash.GetHash(Digest.Hash);
+		const FString Name = Digest.ToString();
+
+		//Fan out over subdirectories so no single directory gets huge
+		return FPaths::Combine(Directory, Name.Left(2), Name);
+	}
+
+	bool FAsyncDiskCache::Load(const FString& Key, TFunctionRef<bool(TArrayView<const uint8>)> Reader) const
+	{
+		const FString Path = GetPath(Key);
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		if (!PlatformFile.FileExists(*Path))
+		{
+			return false;
+		}
+
+		TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*Path));
+		if (MappedFile.IsValid())
+		{
+			TUniquePtr<IMappedFileRegion> Region(MappedFile->MapRegion());
+			if (Region.IsValid())
+			{
+				//Readers take an int32 sized view, and Store never writes an entry bigger than that
+				const int64 Size = Region->GetMappedSize();
+				return Size <= MAX_int32 && Private::ReadDiskCacheEntry(TArrayView<const uint8>(Region->GetMappedPtr(), (int32)Size), Reader);
+			}
+		}
+
+		//Not every platform can map files
+		TArray<uint8> Bytes;
+		return FFileHelper::LoadFileToArray(Bytes, *Path, FILEREAD_Silent) && Private::ReadDiskCacheEntry(Bytes, Reader);
+	}
+
+	bool FAsyncDiskCache::Store(const FString& Key, TArrayView<const uint8> Payload) const
+	{
+		//Too big to load back into a view with the header in front of it
+		if ((int64)Payload.Num() + (int64)sizeof(Private::FDiskCacheEntryHeader) > MAX_int32)
+		{
+			return false;
+		}
+
+		const FString Path = GetPath(Key);
+		const FString TempPath = Path + TEXT(".") + FGuid::NewGuid().ToString() + TEXT(".tmp");
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		PlatformFile.CreateDirectoryTree(*FPaths::GetPath(Path));
+
+		{
+			TUniquePtr<IFileHandle> File(PlatformFile.OpenWrite(*TempPath));
+			if (!File.IsValid())
+			{
+				return false;
+			}
+
+			const Private::FDiskCacheEntryHeader Header{ Private::FDiskCacheEntryHeader::ExpectedMagic, FCrc::MemCrc32(Payload.GetData(), Payload.Num()), (uint64)Payload.Num() };
+			if (!File->Write((const uint8*)&Header, sizeof(Private::FDiskCacheEntryHeader)) || !File->Write(Payload.GetData(), Payload.Num()) || !File->Flush())
+			{
+				File.Reset();
+				PlatformFile.DeleteFile(*TempPath);
+				return false;
+			}
+		}
+
+		if (PlatformFile.MoveFile(*Path, *TempPath))
+		{
+			return true;
+		}
+
+		//Entries are deterministic for their key, so losing the race to another writer is fine
+		PlatformFile.DeleteFile(*TempPath);
+		return PlatformFile.FileExists(*Path);
+	}
+
+	bool FAsyncDiskCache::Remove(const FString& Key) const
+	{
+		return FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*GetPath(Key));
+	}
+}
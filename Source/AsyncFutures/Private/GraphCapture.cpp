@@ -0,0 +1,656 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include "GraphCapture.h"
+#include <atomic>
+
+// Engine Includes
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTLS.h"
+#include "HAL/ThreadManager.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/OutputDevice.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+// Module Includes
+#include "AsyncFuturesModule.h"
+
+namespace UE::Tasks
+{
+	namespace Private
+	{
+		static TAutoConsoleVariable<int32> CVarGraphMaxNodes(
+			TEXT("AsyncFutures.Graph.MaxNodes"),
+			100000,
+			TEXT("Promises a graph capture records before it stops adding more, so a capture left running can't grow without bound."),
+			ECVF_Default);
+
+		struct FCapturedNode
+		{
+			uint64 CreatedCycles = 0;
+			uint64 FulfilledCycles = 0;
+			uint64 StartCycles = 0;
+			uint64 EndCycles = 0;
+			const TCHAR* Name = nullptr;
+			const ANSICHAR* File = nullptr;
+			int32 Line = 0;
+			uint32 ThreadId = 0;
+			int32 CreatedBy = INDEX_NONE;
+			int32 FulfilledBy = INDEX_NONE;
+			bool bError = false;
+			bool bDiscarded = false;
+		};
+
+		struct FCapturedEdge
+		{
+			int32 From = INDEX_NONE;
+			int32 To = INDEX_NONE;
+			EFutureGraphEdge Kind = EFutureGraphEdge::Continuation;
+		};
+
+		static thread_local uint64 RunningNodeId = 0;
+
+		class FGraphRecorder
+		{
+		public:
+			//Never destroyed, promises held by other statics can still be fulfilled during shutdown
+			static FGraphRecorder& Get()
+			{
+				static FGraphRecorder* Recorder = new FGraphRecorder();
+				return *Recorder;
+			}
+
+			void Begin(const bool bInWindow)
+			{
+				FScopeLock Lock(&CriticalSection);
+				//Nodes from an earlier capture carry its session, so promises still holding them drop out of this one
+				++Session;
+				BeginCycles = FPlatformTime::Cycles64();
+				Nodes.Reset();
+				Edges.Reset();
+				NumDropped = 0;
+				bActive = true;
+				bWindow = bInWindow;
+			}
+
+			bool IsActive() const { return bActive; }
+
+			uint64 Created()
+			{
+				if (!bWindow)
+				{
+					return 0;
+				}
+				FScopeLock Lock(&CriticalSection);
+				return bWindow ? AddNode() : 0;
+			}
+
+			uint64 CreatedRoot(const bool bSet)
+			{
+				FScopeLock Lock(&CriticalSection);
+				const uint64 NodeId = AddNode();
+				if (bSet && NodeId != 0)
+				{
+					Nodes.Last().FulfilledCycles = Nodes.Last().CreatedCycles;
+				}
+				return NodeId;
+			}
+
+			void SetCallSite(const uint64 NodeId, const FCallSite& CallSite)
+			{
+				FScopeLock Lock(&CriticalSection);
+				if (FCapturedNode* Node = Find(NodeId))
+				{
+					Node->File = CallSite.File;
+					Node->Line = CallSite.Line;
+				}
+			}
+
+			void Fulfilled(const uint64 NodeId, const bool bError)
+			{
+				const uint64 Cycles = FPlatformTime::Cycles64();
+				FScopeLock Lock(&CriticalSection);
+				const int32 Index = ToIndex(NodeId);
+				if (Index != INDEX_NONE)
+				{
+					Nodes[Index].FulfilledCycles = Cycles;
+					Nodes[Index].bError = bError;
+					const int32 Running = ToIndex(RunningNodeId);
+					Nodes[Index].FulfilledBy = Running != Index ? Running : INDEX_NONE;
+				}
+			}
+
+			uint64 Continuation(const uint64 AntecedentId, uint64 NodeId, const TCHAR* Name, const FCallSite* CallSite)
+			{
+				FScopeLock Lock(&CriticalSection);
+				const int32 Antecedent = ToIndex(AntecedentId);
+				if (ToIndex(NodeId) == INDEX_NONE)
+				{
+					NodeId = Antecedent != INDEX_NONE ? AddNode() : 0;
+				}
+
+				const int32 Index = ToIndex(NodeId);
+				if (Index == INDEX_NONE)
+				{
+					return 0;
+				}
+
+				Nodes[Index].Name = Name;
+				if (CallSite != nullptr)
+				{
+					Nodes[Index].File = CallSite->File;
+					Nodes[Index].Line = CallSite->Line;
+				}
+				if (Antecedent != INDEX_NONE)
+				{
+					Edges.Add(FCapturedEdge{ Antecedent, Index, EFutureGraphEdge::Continuation });
+				}
+				return NodeId;
+			}
+
+			uint64 Forwarded(uint64 FutureId, const uint64 NodeId, const bool bFutureSet)
+			{
+				FScopeLock Lock(&CriticalSection);
+				const int32 Index = ToIndex(NodeId);
+				if (Index == INDEX_NONE)
+				{
+					return FutureId;
+				}
+
+				if (ToIndex(FutureId) == INDEX_NONE)
+				{
+					FutureId = AddNode();
+					if (bFutureSet && FutureId != 0)
+					{
+						Nodes.Last().FulfilledCycles = Nodes.Last().CreatedCycles;
+					}
+				}
+
+				const int32 Future = ToIndex(FutureId);
+				if (Future != INDEX_NONE)
+				{
+					Edges.Add(FCapturedEdge{ Future, Index, EFutureGraphEdge::Forwarded });
+				}
+				return FutureId;
+			}
+
+			void Discard(const uint64 NodeId)
+			{
+				FScopeLock Lock(&CriticalSection);
+				if (FCapturedNode* Node = Find(NodeId))
+				{
+					Node->bDiscarded = true;
+				}
+			}
+
+			void Executed(const uint64 NodeId, const uint64 StartCycles, const uint64 EndCycles)
+			{
+				const uint32 ThreadId = FPlatformTLS::GetCurrentThreadId();
+				FScopeLock Lock(&CriticalSection);
+				if (FCapturedNode* Node = Find(NodeId))
+				{
+					Node->StartCycles = StartCycles;
+					Node->EndCycles = EndCycles;
+					Node->ThreadId = ThreadId;
+				}
+			}
+
+			FFutureGraph End();
+
+		private:
+			//Index of a node from the running capture, INDEX_NONE for anything else
+			int32 ToIndex(const uint64 NodeId) const
+			{
+				if (!bActive || NodeId == 0 || uint32(NodeId >> 32) != Session)
+				{
+					return INDEX_NONE;
+				}
+				const int32 Index = int32(NodeId & MAX_uint32) - 1;
+				return Nodes.IsValidIndex(Index) ? Index : INDEX_NONE;
+			}
+
+			FCapturedNode* Find(const uint64 NodeId)
+			{
+				const int32 Index = ToIndex(NodeId);
+				return Index != INDEX_NONE ? &Nodes[Index] : nullptr;
+			}
+
+			uint64 AddNode()
+			{
+				if (!bActive)
+				{
+					return 0;
+				}
+				if (Nodes.Num() >= CVarGraphMaxNodes.GetValueOnAnyThread())
+				{
+					++NumDropped;
+					return 0;
+				}
+				const int32 CreatedBy = ToIndex(RunningNodeId);
+				FCapturedNode& Node = Nodes.AddDefaulted_GetRef();
+				Node.CreatedCycles = FPlatformTime::Cycles64();
+				Node.CreatedBy = CreatedBy;
+				return (uint64(Session) << 32) | uint64(Nodes.Num());
+			}
+
+			FCriticalSection CriticalSection;
+			std::atomic_bool bActive = false;
+			std::atomic_bool bWindow = false;
+			uint32 Session = 0;
+			uint64 BeginCycles = 0;
+			uint64 NumDropped = 0;
+			TArray<FCapturedNode> Nodes;
+			TArray<FCapturedEdge> Edges;
+		};
+
+		static double ToCaptureMs(const uint64 Cycles, const uint64 BeginCycles)
+		{
+			return Cycles != 0 ? FPlatformTime::ToMilliseconds64(Cycles - FMath::Min(Cycles, BeginCycles)) : -1.0;
+		}
+
+		//Latest fulfilled of the edges of the given kind into a node
+		static int32 FindGatingEdge(const FFutureGraph& Graph, const TArray<int32>& Incoming, const EFutureGraphEdge Kind)
+		{
+			int32 Gating = INDEX_NONE;
+			for (const int32 Edge : Incoming)
+			{
+				const double Fulfilled = Graph.Nodes[Graph.Edges[Edge].From - 1].FulfilledMs;
+				if (Graph.Edges[Edge].Kind == Kind && Fulfilled >= 0.0 && (Gating == INDEX_NONE || Fulfilled > Graph.Nodes[Graph.Edges[Gating].From - 1].FulfilledMs))
+				{
+					Gating = Edge;
+				}
+			}
+			return Gating;
+		}
+
+		//Walks back from the last promise to be fulfilled, through whichever promise it waited on was fulfilled last.
+		//A continuation that returned a future waited on that future to finish, and on the stage before it to start,
+		//so once the future's own chain runs out the walk carries on from the stage before the continuation.
+		static void FindCriticalPath(FFutureGraph& Graph)
+		{
+			int32 Current = INDEX_NONE;
+			for (int32 Index = 0; Index < Graph.Nodes.Num(); ++Index)
+			{
+				if (Graph.Nodes[Index].FulfilledMs >= 0.0 && (Current == INDEX_NONE || Graph.Nodes[Index].FulfilledMs > Graph.Nodes[Current].FulfilledMs))
+				{
+					Current = Index;
+				}
+			}
+
+			TArray<TArray<int32>> Incoming;
+			Incoming.SetNum(Graph.Nodes.Num());
+			for (int32 Edge = 0; Edge < Graph.Edges.Num(); ++Edge)
+			{
+				Incoming[Graph.Edges[Edge].To - 1].Add(Edge);
+			}
+
+			TArray<int32> Resume;
+			while (true)
+			{
+				if (Current == INDEX_NONE || Graph.Nodes[Current].bCritical)
+				{
+					if (Resume.Num() == 0)
+					{
+						break;
+					}
+					const int32 Edge = Resume.Pop();
+					Graph.Edges[Edge].bCritical = true;
+					Current = Graph.Edges[Edge].From - 1;
+					continue;
+				}
+
+				Graph.Nodes[Current].bCritical = true;
+				Graph.CriticalPath.Insert(Graph.Nodes[Current].Id, 0);
+
+				const int32 Forwarded = FindGatingEdge(Graph, Incoming[Current], EFutureGraphEdge::Forwarded);
+				const int32 Continuation = FindGatingEdge(Graph, Incoming[Current], EFutureGraphEdge::Continuation);
+				Current = INDEX_NONE;
+				if (Forwarded != INDEX_NONE)
+				{
+					Graph.Edges[Forwarded].bCritical = true;
+					Current = Graph.Edges[Forwarded].From - 1;
+					if (Continuation != INDEX_NONE)
+					{
+						Resume.Push(Continuation);
+					}
+				}
+				else if (Continuation != INDEX_NONE)
+				{
+					Graph.Edges[Continuation].bCritical = true;
+					Current = Graph.Edges[Continuation].From - 1;
+				}
+			}
+		}
+
+		FFutureGraph FGraphRecorder::End()
+		{
+			TArray<FCapturedNode> CapturedNodes;
+			TArray<FCapturedEdge> CapturedEdges;
+			uint64 Begin = 0;
+			uint64 Dropped = 0;
+			{
+				FScopeLock Lock(&CriticalSection);
+				if (!bActive)
+				{
+					return FFutureGraph();
+				}
+				bActive = false;
+				bWindow = false;
+				CapturedNodes = MoveTemp(Nodes);
+				CapturedEdges = MoveTemp(Edges);
+				Begin = BeginCycles;
+				Dropped = NumDropped;
+			}
+
+			if (Dropped > 0)
+			{
+				UE_LOG(LogAsyncFutures, Warning, TEXT("Graph capture left out %llu promises after reaching AsyncFutures.Graph.MaxNodes"), Dropped);
+			}
+
+			FFutureGraph Graph;
+			Graph.DurationMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - Begin);
+
+			//Discarded nodes are left out, so ids are renumbered from 1
+			TArray<int32> Ids;
+			Ids.Init(0, CapturedNodes.Num());
+			for (int32 Index = 0; Index < CapturedNodes.Num(); ++Index)
+			{
+				const FCapturedNode& Captured = CapturedNodes[Index];
+				if (Captured.bDiscarded)
+				{
+					continue;
+				}
+
+				FFutureGraphNode& Node = Graph.Nodes.AddDefaulted_GetRef();
+				Node.Id = Graph.Nodes.Num();
+				Ids[Index] = Node.Id;
+				Node.Name = Captured.Name != nullptr ? Captured.Name : TEXT("");
+				Node.File = Captured.File != nullptr ? FString(Captured.File) : FString();
+				Node.Line = Captured.Line;
+				Node.Thread = Captured.ThreadId != 0 ? FThreadManager::GetThreadName(Captured.ThreadId) : FString();
+				Node.CreatedMs = ToCaptureMs(Captured.CreatedCycles, Begin);
+				Node.StartedMs = ToCaptureMs(Captured.StartCycles, Begin);
+				Node.EndedMs = ToCaptureMs(Captured.EndCycles, Begin);
+				Node.FulfilledMs = ToCaptureMs(Captured.FulfilledCycles, Begin);
+				Node.bError = Captured.bError;
+			}
+
+			//Nodes the graph left out don't count as having created or fulfilled anything
+			const auto ToId = [&Ids](const int32 Index) { return Index != INDEX_NONE ? Ids[Index] : 0; };
+			for (int32 Index = 0; Index < CapturedNodes.Num(); ++Index)
+			{
+				if (Ids[Index] != 0)
+				{
+					Graph.Nodes[Ids[Index] - 1].CreatedBy = ToId(CapturedNodes[Index].CreatedBy);
+					Graph.Nodes[Ids[Index] - 1].FulfilledBy = ToId(CapturedNodes[Index].FulfilledBy);
+				}
+			}
+
+			for (const FCapturedEdge& Captured : CapturedEdges)
+			{
+				if (Ids[Captured.From] == 0 || Ids[Captured.To] == 0)
+				{
+					continue;
+				}
+
+				FFutureGraphEdge& Edge = Graph.Edges.AddDefaulted_GetRef();
+				Edge.From = Ids[Captured.From];
+				Edge.To = Ids[Captured.To];
+				Edge.Kind = Captured.Kind;
+				if (Edge.Kind == EFutureGraphEdge::Continuation)
+				{
+					Graph.Nodes[Edge.To - 1].ReadyMs = Graph.Nodes[Edge.From - 1].FulfilledMs;
+				}
+			}
+
+			FindCriticalPath(Graph);
+			return Graph;
+		}
+
+		static FString Escape(const FString& Text)
+		{
+			return Text.Replace(TEXT("\\"), TEXT("\\\\")).Replace(TEXT("\""), TEXT("\\\""));
+		}
+
+		//Control characters aren't allowed in JSON strings, and names, files and threads can hold any
+		static FString EscapeJson(const FString& Text)
+		{
+			FString Escaped;
+			Escaped.Reserve(Text.Len());
+			for (const TCHAR Char : Text)
+			{
+				switch (Char)
+				{
+				case TEXT('\\'):	Escaped += TEXT("\\\\"); break;
+				case TEXT('"'):		Escaped += TEXT("\\\""); break;
+				case TEXT('\n'):	Escaped += TEXT("\\n"); break;
+				case TEXT('\r'):	Escaped += TEXT("\\r"); break;
+				case TEXT('\t'):	Escaped += TEXT("\\t"); break;
+				case TEXT('\b'):	Escaped += TEXT("\\b"); break;
+				case TEXT('\f'):	Escaped += TEXT("\\f"); break;
+				default:
+					if (Char < 0x20)
+					{
+						Escaped += FString::Printf(TEXT("\\u%04x"), (uint32)Char);
+					}
+					else
+					{
+						Escaped.AppendChar(Char);
+					}
+				}
+			}
+			return Escaped;
+		}
+
+		static FString JsonMs(const double Ms)
+		{
+			return Ms >= 0.0 ? FString::Printf(TEXT("%.3f"), Ms) : FString(TEXT("null"));
+		}
+
+		static FString DescribeTiming(const FFutureGraphNode& Node)
+		{
+			TArray<FString> Parts;
+			if (Node.ReadyMs >= 0.0 && Node.StartedMs >= 0.0)
+			{
+				Parts.Add(FString::Printf(TEXT("queued %.2fms"), Node.StartedMs - Node.ReadyMs));
+			}
+			if (Node.StartedMs >= 0.0 && Node.EndedMs >= 0.0)
+			{
+				Parts.Add(FString::Printf(TEXT("ran %.2fms"), Node.EndedMs - Node.StartedMs));
+			}
+			if (Node.FulfilledMs >= 0.0)
+			{
+				Parts.Add(FString::Printf(TEXT("done at %.2fms"), Node.FulfilledMs));
+			}
+			else
+			{
+				Parts.Add(TEXT("not fulfilled"));
+			}
+			return FString::Join(Parts, TEXT(", "));
+		}
+
+		static FAutoConsoleCommand BeginGraphCommand(
+			TEXT("AsyncFutures.Graph.Begin"),
+			TEXT("Starts recording every promise and continuation, until AsyncFutures.Graph.End."),
+			FConsoleCommandDelegate::CreateLambda([]()
+			{
+				BeginGraphCapture();
+			}));
+
+		static FAutoConsoleCommandWithWorldArgsAndOutputDevice EndGraphCommand(
+			TEXT("AsyncFutures.Graph.End"),
+			TEXT("Stops recording and writes the graph as Graphviz and JSON to Saved/AsyncFutures/Graphs. Optionally takes the file name, without an extension."),
+			FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld*, FOutputDevice& Output)
+			{
+				if (!IsCapturingGraph())
+				{
+					Output.Log(TEXT("No graph capture is running, start one with AsyncFutures.Graph.Begin"));
+					return;
+				}
+
+				const FFutureGraph Graph = EndGraphCapture();
+				const FString BaseName = Args.Num() > 0 ? Args[0] : FString::Printf(TEXT("Graph-%s"), *FDateTime::Now().ToString());
+				const FString BasePath = FPaths::Combine(GetDefaultGraphDirectory(), BaseName);
+				if (!Graph.Save(BasePath))
+				{
+					Output.Logf(TEXT("Couldn't write the graph to %s"), *BasePath);
+					return;
+				}
+
+				Output.Logf(TEXT("%d promises and %d edges over %.2fms written to %s.dot and .json"), Graph.Nodes.Num(), Graph.Edges.Num(), Graph.DurationMs, *BasePath);
+				Output.Log(TEXT("Critical path:"));
+				for (const int32 Id : Graph.CriticalPath)
+				{
+					const FFutureGraphNode& Node = Graph.Nodes[Id - 1];
+					Output.Logf(TEXT("  %s %s(%d) %s"), Node.Name.IsEmpty() ? TEXT("(unnamed)") : *Node.Name, *FPaths::GetCleanFilename(Node.File), Node.Line, *DescribeTiming(Node));
+				}
+			}));
+
+		uint64 CapturePromiseCreated()
+		{
+			return FGraphRecorder::Get().Created();
+		}
+
+		void CaptureCallSite(const uint64 NodeId, const FCallSite& CallSite)
+		{
+			FGraphRecorder::Get().SetCallSite(NodeId, CallSite);
+		}
+
+		void CapturePromiseFulfilled(const uint64 NodeId, const bool bError)
+		{
+			FGraphRecorder::Get().Fulfilled(NodeId, bError);
+		}
+
+		uint64 CaptureContinuation(const uint64 AntecedentId, const uint64 NodeId, const TCHAR* Name, const FCallSite* CallSite)
+		{
+			return FGraphRecorder::Get().Continuation(AntecedentId, NodeId, Name, CallSite);
+		}
+
+		uint64 CaptureForwarded(const uint64 FutureId, const uint64 NodeId, const bool bFutureSet)
+		{
+			return FGraphRecorder::Get().Forwarded(FutureId, NodeId, bFutureSet);
+		}
+
+		void DiscardCapturedNode(const uint64 NodeId)
+		{
+			FGraphRecorder::Get().Discard(NodeId);
+		}
+
+		uint64 BeginGraphCaptureFrom(const bool bSet)
+		{
+			FGraphRecorder::Get().Begin(false);
+			return FGraphRecorder::Get().CreatedRoot(bSet);
+		}
+
+		void CaptureExecution(const uint64 NodeId, const uint64 StartCycles, const uint64 EndCycles)
+		{
+			FGraphRecorder::Get().Executed(NodeId, StartCycles, EndCycles);
+		}
+
+		uint64 SetRunningCapturedNode(const uint64 NodeId)
+		{
+			const uint64 Outer = RunningNodeId;
+			RunningNodeId = NodeId;
+			return Outer;
+		}
+	}
+
+	FString FFutureGraph::ToDot() const
+	{
+		FString Dot = TEXT("digraph Futures\n{\n\trankdir=LR;\n\tnode [shape=box, fontname=\"Helvetica\"];\n");
+		for (const FFutureGraphNode& Node : Nodes)
+		{
+			FString Label = Node.Name.IsEmpty() ? TEXT("(unnamed)") : Node.Name;
+			if (!Node.File.IsEmpty())
+			{
+				Label += FString::Printf(TEXT("\n%s(%d)"), *FPaths::GetCleanFilename(Node.File), Node.Line);
+			}
+			if (!Node.Thread.IsEmpty())
+			{
+				Label += TEXT("\n") + Node.Thread;
+			}
+			Label += TEXT("\n") + Private::DescribeTiming(Node);
+
+			FString Style = Node.bCritical ? TEXT(", color=red, penwidth=2") : TEXT("");
+			if (Node.bError)
+			{
+				Style += TEXT(", style=dashed");
+			}
+			Dot += FString::Printf(TEXT("\tn%d [label=\"%s\"%s];\n"), Node.Id, *Private::Escape(Label).Replace(TEXT("\n"), TEXT("\\n")), *Style);
+		}
+		for (const FFutureGraphEdge& Edge : Edges)
+		{
+			TArray<FString> Attributes;
+			if (Edge.Kind == EFutureGraphEdge::Forwarded)
+			{
+				Attributes.Add(TEXT("style=dashed"));
+			}
+			if (Edge.bCritical)
+			{
+				Attributes.Add(TEXT("color=red"));
+				Attributes.Add(TEXT("penwidth=2"));
+			}
+			Dot += Attributes.Num() > 0
+				? FString::Printf(TEXT("\tn%d -> n%d [%s];\n"), Edge.From, Edge.To, *FString::Join(Attributes, TEXT(", ")))
+				: FString::Printf(TEXT("\tn%d -> n%d;\n"), Edge.From, Edge.To);
+		}
+		Dot += TEXT("}\n");
+		return Dot;
+	}
+
+	FString FFutureGraph::ToJson() const
+	{
+		TArray<FString> NodeEntries;
+		for (const FFutureGraphNode& Node : Nodes)
+		{
+			NodeEntries.Add(FString::Printf(
+				TEXT("{\"id\":%d,\"name\":\"%s\",\"file\":\"%s\",\"line\":%d,\"thread\":\"%s\",\"createdMs\":%s,\"readyMs\":%s,\"startedMs\":%s,\"endedMs\":%s,\"fulfilledMs\":%s,\"createdBy\":%d,\"fulfilledBy\":%d,\"error\":%s,\"critical\":%s}"),
+				Node.Id, *Private::EscapeJson(Node.Name), *Private::EscapeJson(Node.File), Node.Line, *Private::EscapeJson(Node.Thread),
+				*Private::JsonMs(Node.CreatedMs), *Private::JsonMs(Node.ReadyMs), *Private::JsonMs(Node.StartedMs), *Private::JsonMs(Node.EndedMs), *Private::JsonMs(Node.FulfilledMs), Node.CreatedBy, Node.FulfilledBy,
+				Node.bError ? TEXT("true") : TEXT("false"), Node.bCritical ? TEXT("true") : TEXT("false")));
+		}
+
+		TArray<FString> EdgeEntries;
+		for (const FFutureGraphEdge& Edge : Edges)
+		{
+			EdgeEntries.Add(FString::Printf(TEXT("{\"from\":%d,\"to\":%d,\"kind\":\"%s\",\"critical\":%s}"),
+				Edge.From, Edge.To, Edge.Kind == EFutureGraphEdge::Forwarded ? TEXT("forwarded") : TEXT("continuation"), Edge.bCritical ? TEXT("true") : TEXT("false")));
+		}
+
+		TArray<FString> PathEntries;
+		for (const int32 Id : CriticalPath)
+		{
+			PathEntries.Add(FString::FromInt(Id));
+		}
+
+		return FString::Printf(TEXT("{\"durationMs\":%.3f,\"criticalPath\":[%s],\"nodes\":[\n%s\n],\"edges\":[\n%s\n]}\n"),
+			DurationMs, *FString::Join(PathEntries, TEXT(",")), *FString::Join(NodeEntries, TEXT(",\n")), *FString::Join(EdgeEntries, TEXT(",\n")));
+	}
+
+	bool FFutureGraph::Save(const FString& BasePath) const
+	{
+		const bool bWroteDot = FFileHelper::SaveStringToFile(ToDot(), *(BasePath + TEXT(".dot")));
+		const bool bWroteJson = FFileHelper::SaveStringToFile(ToJson(), *(BasePath + TEXT(".json")));
+		return bWroteDot && bWroteJson;
+	}
+
+	void BeginGraphCapture()
+	{
+		Private::FGraphRecorder::Get().Begin(true);
+	}
+
+	FFutureGraph EndGraphCapture()
+	{
+		return Private::FGraphRecorder::Get().End();
+	}
+
+	bool IsCapturingGraph()
+	{
+		return Private::FGraphRecorder::Get().IsActive();
+	}
+
+	FString GetDefaultGraphDirectory()
+	{
+		return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("AsyncFutures"), TEXT("Graphs"));
+	}
+}
@@ -0,0 +1,244 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include "Metrics.h"
+#include <atomic>
+
+// Engine Includes
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/OutputDevice.h"
+#include "Misc/ScopeLock.h"
+#include "Templates/UniquePtr.h"
+
+namespace UE::Tasks
+{
+	void FAsyncFuturesHistogram::Add(const FAsyncFuturesHistogram& Other)
+	{
+		for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+		{
+			Buckets[Bucket] += Other.Buckets[Bucket];
+		}
+		Count += Other.Count;
+		TotalSeconds += Other.TotalSeconds;
+	}
+
+	double FAsyncFuturesHistogram::GetPercentile(const double Percentile) const
+	{
+		if (Count == 0)
+		{
+			return 0.0;
+		}
+
+		const uint64 Target = FMath::Max<uint64>((uint64)FMath::CeilToDouble(FMath::Clamp(Percentile, 0.0, 1.0) * Count), 1);
+		uint64 Seen = 0;
+		for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+		{
+			Seen += Buckets[Bucket];
+			if (Seen >= Target)
+			{
+				return GetBucketUpperBound(Bucket);
+			}
+		}
+		return GetBucketUpperBound(NumBuckets - 1);
+	}
+
+	int32 FAsyncFuturesHistogram::GetBucket(const uint64 Microseconds)
+	{
+		return Microseconds == 0 ? 0 : FMath::Min((int32)FMath::FloorLog2_64(Microseconds) + 1, NumBuckets - 1);
+	}
+
+	double FAsyncFuturesHistogram::GetBucketUpperBound(const int32 Bucket)
+	{
+		return (double)(1ull << Bucket) / 1000000.0;
+	}
+
+	uint64 FAsyncFuturesMetrics::GetTotalScheduled() const
+	{
+		uint64 Total = 0;
+		for (int32 Execution = 0; Execution < NumExecutions; ++Execution)
+		{
+			Total += Scheduled[Execution];
+		}
+		return Total;
+	}
+
+	FString FAsyncFuturesMetrics::ToString() const
+	{
+		FString Result = FString::Printf(TEXT("Live promises: %lld (%llu created)\n"), LivePromises, PromisesCreated);
+		for (int32 Execution = 0; Execution < NumExecutions; ++Execution)
+		{
+			Result += FString::Printf(TEXT("Scheduled on %s: %llu\n"), Private::GetExecutionName((EAsyncExecution)Execution), Scheduled[Execution]);
+		}
+		Result += FString::Printf(TEXT("Fused: %llu\nCancellations: %llu\nLifetime expired: %llu\n"), Fused, Cancellations, LifetimeExpired);
+
+		const auto PrintHistogram = [&Result](const TCHAR* Name, const FAsyncFuturesHistogram& Histogram)
+		{
+			Result += FString::Printf(TEXT("%s: avg %.1fus, p50 <%.0fus, p99 <%.0fus, count %llu\n"), Name,
+				Histogram.GetAverage() * 1000000.0, Histogram.GetPercentile(0.5) * 1000000.0, Histogram.GetPercentile(0.99) * 1000000.0, Histogram.Count);
+		};
+		PrintHistogram(TEXT("Schedule latency"), ScheduleLatency);
+		PrintHistogram(TEXT("Run time"), RunTime);
+		return Result;
+	}
+
+	namespace Private
+	{
+		//Only ever written by the thread that owns it, so increments don't need to be atomic read-modify-writes
+		struct FThreadMetrics
+		{
+			struct FHistogram
+			{
+				std::atomic<uint64> Buckets[FAsyncFuturesHistogram::NumBuckets] = {};
+				std::atomic<uint64> TotalCycles = 0;
+			};
+
+			std::atomic<uint64> PromisesCreated = 0;
+			std::atomic<uint64> PromisesDestroyed = 0;
+			std::atomic<uint64> Scheduled[FAsyncFuturesMetrics::NumExecutions] = {};
+			std::atomic<uint64> Fused = 0;
+			std::atomic<uint64> Cancellations = 0;
+			std::atomic<uint64> LifetimeExpired = 0;
+			FHistogram ScheduleLatency;
+			FHistogram RunTime;
+		};
+
+		static void Increment(std::atomic<uint64>& Counter, const uint64 Amount = 1)
+		{
+			Counter.store(Counter.load(std::memory_order_relaxed) + Amount, std::memory_order_relaxed);
+		}
+
+		static void AddSample(FThreadMetrics::FHistogram& Histogram, const uint64 Cycles)
+		{
+			const uint64 Microseconds = (uint64)(FPlatformTime::ToSeconds64(Cycles) * 1000000.0);
+			Increment(Histogram.Buckets[FAsyncFuturesHistogram::GetBucket(Microseconds)]);
+			Increment(Histogram.TotalCycles, Cycles);
+		}
+
+		static void GatherHistogram(const FThreadMetrics::FHistogram& Histogram, FAsyncFuturesHistogram& Out)
+		{
+			for (int32 Bucket = 0; Bucket < FAsyncFuturesHistogram::NumBuckets; ++Bucket)
+			{
+				const uint64 Samples = Histogram.Buckets[Bucket].load(std::memory_order_relaxed);
+				Out.Buckets[Bucket] += Samples;
+				Out.Count += Samples;
+			}
+			Out.TotalSeconds += FPlatformTime::ToSeconds64(Histogram.TotalCycles.load(std::memory_order_relaxed));
+		}
+
+		//Blocks outlive the threads that used them. A finished thread's block is handed to the next new thread so the totals carry on
+		class FMetricsRegistry
+		{
+		public:
+			static FMetricsRegistry& Get()
+			{
+				static FMetricsRegistry Registry;
+				return Registry;
+			}
+
+			FThreadMetrics* Acquire()
+			{
+				FScopeLock Lock(&CriticalSection);
+				if (Free.Num() > 0)
+				{
+					return Free.Pop();
+				}
+				return Blocks.Add_GetRef(MakeUnique<FThreadMetrics>()).Get();
+			}
+
+			void Release(FThreadMetrics* Block)
+			{
+				FScopeLock Lock(&CriticalSection);
+				Free.Add(Block);
+			}
+
+			FAsyncFuturesMetrics Gather()
+			{
+				FAsyncFuturesMetrics Metrics;
+				uint64 Destroyed = 0;
+
+				FScopeLock Lock(&CriticalSection);
+				for (const TUniquePtr<FThreadMetrics>& Block : Blocks)
+				{
+					Metrics.PromisesCreated += Block->PromisesCreated.load(std::memory_order_relaxed);
+					Destroyed += Block->PromisesDestroyed.load(std::memory_order_relaxed);
+					for (int32 Execution = 0; Execution < FAsyncFuturesMetrics::NumExecutions; ++Execution)
+					{
+						Metrics.Scheduled[Execution] += Block->Scheduled[Execution].load(std::memory_order_relaxed);
+					}
+					Metrics.Fused += Block->Fused.load(std::memory_order_relaxed);
+					Metrics.Cancellations += Block->Cancellations.load(std::memory_order_relaxed);
+					Metrics.LifetimeExpired += Block->LifetimeExpired.load(std::memory_order_relaxed);
+					GatherHistogram(Block->ScheduleLatency, Metrics.ScheduleLatency);
+					GatherHistogram(Block->RunTime, Metrics.RunTime);
+				}
+
+				//Promises are often destroyed on a different thread from the one that created them, so only the totals balance
+				Metrics.LivePromises = (int64)Metrics.PromisesCreated - (int64)Destroyed;
+				return Metrics;
+			}
+
+		private:
+			FCriticalSection CriticalSection;
+			TArray<TUniquePtr<FThreadMetrics>> Blocks;
+			TArray<FThreadMetrics*> Free;
+		};
+
+		struct FThreadMetricsOwner
+		{
+			FThreadMetricsOwner() : Block(FMetricsRegistry::Get().Acquire()) {}
+			~FThreadMetricsOwner() { FMetricsRegistry::Get().Release(Block); }
+
+			FThreadMetrics* Block;
+		};
+
+		static FThreadMetrics& GetThreadMetrics()
+		{
+			static thread_local FThreadMetricsOwner Owner;
+			return *Owner.Block;
+		}
+
+		static FAutoConsoleCommandWithOutputDevice MetricsCommand(
+			TEXT("AsyncFutures.Metrics"),
+			TEXT("Prints the plugin's live promise, scheduling, latency and run time counters."),
+			FConsoleCommandWithOutputDeviceDelegate::CreateLambda([](FOutputDevice& Output)
+			{
+				TArray<FString> Lines;
+				GatherMetrics().ToString().ParseIntoArrayLines(Lines);
+				for (const FString& Line : Lines)
+				{
+					Output.Log(Line);
+				}
+			}));
+
+		const TCHAR* GetExecutionName(const EAsyncExecution Execution)
+		{
+			static const TCHAR* ExecutionNames[FAsyncFuturesMetrics::NumExecutions] = { TEXT("TaskGraph"), TEXT("TaskGraphMainThread"), TEXT("Thread"), TEXT("ThreadIfForkSafe"), TEXT("ThreadPool"), TEXT("LargeThreadPool") };
+			return ExecutionNames[FMath::Clamp((int32)Execution, 0, FAsyncFuturesMetrics::NumExecutions - 1)];
+		}
+
+		void RecordPromiseCreated() { Increment(GetThreadMetrics().PromisesCreated); }
+		void RecordPromiseDestroyed() { Increment(GetThreadMetrics().PromisesDestroyed); }
+		void RecordCancellation() { Increment(GetThreadMetrics().Cancellations); }
+		void RecordLifetimeExpired() { Increment(GetThreadMetrics().LifetimeExpired); }
+		void RecordFused() { Increment(GetThreadMetrics().Fused); }
+
+		void RecordScheduled(const EAsyncExecution Execution)
+		{
+			Increment(GetThreadMetrics().Scheduled[FMath::Clamp((int32)Execution, 0, FAsyncFuturesMetrics::NumExecutions - 1)]);
+		}
+
+		void RecordStarted(const uint64 ScheduledCycles, const uint64 StartCycles)
+		{
+			AddSample(GetThreadMetrics().ScheduleLatency, StartCycles - ScheduledCycles);
+		}
+
+		void RecordFinished(const uint64 StartCycles, const uint64 EndCycles)
+		{
+			AddSample(GetThreadMetrics().RunTime, EndCycles - StartCycles);
+		}
+
+		FAsyncFuturesMetrics GatherMetrics()
+		{
+			return FMetricsRegistry::Get().Gather();
+		}
+	}
+}
@@ -0,0 +1,463 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include "PromiseLeaks.h"
+#include <atomic>
+
+// Engine Includes
+#include "Containers/Map.h"
+#include "Containers/Ticker.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/OutputDevice.h"
+#include "Misc/ScopeLock.h"
+
+// Module Includes
+#include "AsyncFuture.h"
+#include "AsyncFuturesModule.h"
+
+namespace UE::Tasks
+{
+	namespace Private
+	{
+		static TAutoConsoleVariable<bool> CVarTrackPromises(
+			TEXT("AsyncFutures.Promises.Track"),
+			false,
+			TEXT("Records where and when each promise was created until it's fulfilled, for AsyncFutures.Promises and broken promise warnings."),
+			ECVF_Default);
+
+		static TAutoConsoleVariable<int32> CVarBrokenPromises(
+			TEXT("AsyncFutures.Promises.Broken"),
+			2,
+			TEXT("What to do when a started promise loses its last TAsyncPromise without being fulfilled.\n")
+			TEXT("0: Count it\n")
+			TEXT("1: Count it and warn\n")
+			TEXT("2: Count it, warn and fulfil it with a broken promise error\n")
+			TEXT("3: Assert"),
+			ECVF_Default);
+
+		static void OnStallSecondsChanged(IConsoleVariable* Variable);
+
+		static TAutoConsoleVariable<float> CVarStallSeconds(
+			TEXT("AsyncFutures.Promises.StallSeconds"),
+			0.0f,
+			TEXT("Warns about promises that have been waiting on a value for longer than this, along with the continuations waiting on them. 0 disables the watchdog, otherwise promises are tracked as if AsyncFutures.Promises.Track was on."),
+			FConsoleVariableDelegate::CreateStatic(&OnStallSecondsChanged),
+			ECVF_Default);
+
+		struct FTrackedPromise
+		{
+			const ANSICHAR* File = nullptr;
+			int32 Line = 0;
+			uint64 CreatedCycles = 0;
+
+			//Only known for continuations
+			bool bDescribed = false;
+			uint64 WaitingOn = 0;
+			const TCHAR* Name = nullptr;
+			EAsyncExecution Execution = EAsyncExecution::TaskGraph;
+			ENamedThreads::Type Thread = ENamedThreads::AnyThread;
+			TOptional<FWeakCancellationHandle> Cancellation;
+
+			bool bStallReported = false;
+		};
+
+		static FString DescribeTarget(const EAsyncExecution Execution, const ENamedThreads::Type Thread)
+		{
+			if (Execution != EAsyncExecution::TaskGraph)
+			{
+				return GetExecutionName(Execution);
+			}
+
+			const ENamedThreads::Type ThreadIndex = ENamedThreads::GetThreadIndex(Thread);
+			if (ThreadIndex == ENamedThreads::GameThread)
+			{
+				return TEXT("TaskGraph (GameThread)");
+			}
+			if (ThreadIndex == ENamedThreads::ActualRenderingThread)
+			{
+				return TEXT("TaskGraph (RenderThread)");
+			}
+			if (ThreadIndex == ENamedThreads::RHIThread)
+			{
+				return TEXT("TaskGraph (RHIThread)");
+			}
+			return TEXT("TaskGraph (AnyThread)");
+		}
+
+		static FString DescribeCancellation(const TOptional<FWeakCancellationHandle>& Cancellation)
+		{
+			if (!Cancellation.IsSet())
+			{
+				return FString();
+			}
+			if (Cancellation->IsCancelled())
+			{
+				return TEXT("cancelled");
+			}
+			return Cancellation->IsValid() ? TEXT("not cancelled") : TEXT("handle released");
+		}
+
+		class FPromiseRegistry
+		{
+		public:
+			//Never destroyed, promises held by other statics can still be dropped during shutdown
+			static FPromiseRegistry& Get()
+			{
+				static FPromiseRegistry* Registry = new FPromiseRegistry();
+				return *Registry;
+			}
+
+			uint64 Track(const FCallSite& CallSite)
+			{
+				FScopeLock Lock(&CriticalSection);
+				const uint64 TrackingId = ++LastId;
+				FTrackedPromise& Promise = Promises.Add(TrackingId);
+				Promise.File = CallSite.File;
+				Promise.Line = CallSite.Line;
+				Promise.CreatedCycles = FPlatformTime::Cycles64();
+				return TrackingId;
+			}
+
+			void Describe(const uint64 TrackingId, const uint64 WaitingOn, const FOptions& Options)
+			{
+				FScopeLock Lock(&CriticalSection);
+				if (FTrackedPromise* Promise = Promises.Find(TrackingId))
+				{
+					Promise->bDescribed = true;
+					Promise->WaitingOn = WaitingOn;
+					Promise->Name = Options.GetName();
+					Promise->Execution = Options.GetExecutionPolicy();
+					Promise->Thread = Options.GetDesiredThread();
+					const TOptional<FCancellationHandle> Cancellation = Options.GetCancellation();
+					if (Cancellation.IsSet())
+					{
+						Promise->Cancellation = FWeakCancellationHandle(Cancellation.GetValue());
+					}
+				}
+			}
+
+			void Relink(const uint64 TrackingId, const uint64 WaitingOn)
+			{
+				FScopeLock Lock(&CriticalSection);
+				if (FTrackedPromise* Promise = Promises.Find(TrackingId))
+				{
+					Promise->WaitingOn = WaitingOn;
+				}
+			}
+
+			void Untrack(const uint64 TrackingId)
+			{
+				FScopeLock Lock(&CriticalSection);
+				Promises.Remove(TrackingId);
+			}
+
+			//Returns how many promises from the same site have been broken, or 0 when the promise wasn't tracked
+			uint64 Break(const uint64 TrackingId, FString& OutSite, double& OutAge)
+			{
+				FScopeLock Lock(&CriticalSection);
+				FTrackedPromise Promise;
+				if (!Promises.RemoveAndCopyValue(TrackingId, Promise))
+				{
+					return 0;
+				}
+
+				OutSite = FString::Printf(TEXT("%s(%d)"), ANSI_TO_TCHAR(Promise.File), Promise.Line);
+				OutAge = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - Promise.CreatedCycles);
+				return ++Broken.FindOrAdd(TPair<const ANSICHAR*, int32>(Promise.File, Promise.Line));
+			}
+
+			TArray<FPendingPromise> GetPending(const double MinAgeSeconds)
+			{
+				TArray<FPendingPromise> Pending;
+				const uint64 Now = FPlatformTime::Cycles64();
+				{
+					FScopeLock Lock(&CriticalSection);
+					for (const TPair<uint64, FTrackedPromise>& Tracked : Promises)
+					{
+						const double AgeSeconds = FPlatformTime::ToSeconds64(Now - Tracked.Value.CreatedCycles);
+						if (AgeSeconds < MinAgeSeconds)
+						{
+							continue;
+						}
+
+						FPendingPromise& Promise = Pending.AddDefaulted_GetRef();
+						Promise.Id = Tracked.Key;
+						Promise.WaitingOn = Tracked.Value.WaitingOn;
+						Promise.File = ANSI_TO_TCHAR(Tracked.Value.File);
+						Promise.Line = Tracked.Value.Line;
+						Promise.AgeSeconds = AgeSeconds;
+						if (Tracked.Value.bDescribed)
+						{
+							Promise.Name = Tracked.Value.Name != nullptr ? Tracked.Value.Name : TEXT("");
+							Promise.Target = DescribeTarget(Tracked.Value.Execution, Tracked.Value.Thread);
+							Promise.Cancellation = DescribeCancellation(Tracked.Value.Cancellation);
+						}
+					}
+				}
+
+				Pending.Sort([](const FPendingPromise& A, const FPendingPromise& B) { return A.AgeSeconds > B.AgeSeconds; });
+				return Pending;
+			}
+
+			//Marks promises older than the threshold as reported, returning how many hadn't been before
+			int32 MarkStalled(const double StallSeconds)
+			{
+				const uint64 Now = FPlatformTime::Cycles64();
+				int32 NewlyStalled = 0;
+
+				FScopeLock Lock(&CriticalSection);
+				for (TPair<uint64, FTrackedPromise>& Tracked : Promises)
+				{
+					if (!Tracked.Value.bStallReported && FPlatformTime::ToSeconds64(Now - Tracked.Value.CreatedCycles) >= StallSeconds)
+					{
+						Tracked.Value.bStallReported = true;
+						++NewlyStalled;
+					}
+				}
+				return NewlyStalled;
+			}
+
+			TArray<FPromiseLeakStats> GetReport()
+			{
+				TArray<FPromiseLeakStats> Report;
+				const uint64 Now = FPlatformTime::Cycles64();
+
+				const auto FindOrAddSite = [&Report](const ANSICHAR* File, const int32 Line) -> FPromiseLeakStats&
+				{
+					const FString SiteFile = ANSI_TO_TCHAR(File);
+					if (FPromiseLeakStats* Existing = Report.FindByPredicate([&SiteFile, Line](const FPromiseLeakStats& Stats) { return Stats.Line == Line && Stats.File == SiteFile; }))
+					{
+						return *Existing;
+					}
+					FPromiseLeakStats& Stats = Report.AddDefaulted_GetRef();
+					Stats.File = SiteFile;
+					Stats.Line = Line;
+					return Stats;
+				};
+
+				{
+					FScopeLock Lock(&CriticalSection);
+					for (const TPair<uint64, FTrackedPromise>& Promise : Promises)
+					{
+						FPromiseLeakStats& Stats = FindOrAddSite(Promise.Value.File, Promise.Value.Line);
+						++Stats.Outstanding;
+						Stats.OldestSeconds = FMath::Max(Stats.OldestSeconds, FPlatformTime::ToSeconds64(Now - Promise.Value.CreatedCycles));
+					}
+					for (const TPair<TPair<const ANSICHAR*, int32>, uint64>& Site : Broken)
+					{
+						FindOrAddSite(Site.Key.Key, Site.Key.Value).Broken += Site.Value;
+					}
+				}
+
+				Report.Sort([](const FPromiseLeakStats& A, const FPromiseLeakStats& B) { return A.OldestSeconds > B.OldestSeconds; });
+				return Report;
+			}
+
+		private:
+			FCriticalSection CriticalSection;
+			uint64 LastId = 0;
+			TMap<uint64, FTrackedPromise> Promises;
+			TMap<TPair<const ANSICHAR*, int32>, uint64> Broken;
+		};
+
+		static std::atomic<uint64> NumBrokenPromises = 0;
+
+		static void AppendChain(const TArray<FPendingPromise>& Pending, const TMultiMap<uint64, int32>& Continuations, const int32 Index, const int32 Depth, FString& Out)
+		{
+			const FPendingPromise& Promise = Pending[Index];
+			Out += FString::ChrN((Depth + 1) * 2, TEXT(' '));
+			Out += Depth == 0 ? TEXT("") : TEXT("<- ");
+			Out += FString::Printf(TEXT("%s(%d) %.2fs"), *Promise.File, Promise.Line, Promise.AgeSeconds);
+			if (!Promise.Name.IsEmpty())
+			{
+				Out += FString::Printf(TEXT(" '%s'"), *Promise.Name);
+			}
+			if (!Promise.Target.IsEmpty())
+			{
+				Out += FString::Printf(TEXT(" on %s"), *Promise.Target);
+			}
+			if (!Promise.Cancellation.IsEmpty())
+			{
+				Out += FString::Printf(TEXT(", cancellation %s"), *Promise.Cancellation);
+			}
+			Out += TEXT("\n");
+
+			//Chains can be as long as a loop of continuations, so deep ones are cut short
+			constexpr int32 MaxDepth = 16;
+			TArray<int32> Children;
+			Continuations.MultiFind(Promise.Id, Children, true);
+			if (Depth + 1 >= MaxDepth && Children.Num() > 0)
+			{
+				Out += FString::ChrN((Depth + 2) * 2, TEXT(' ')) + FString::Printf(TEXT("<- %d more...\n"), Children.Num());
+				return;
+			}
+			for (const int32 Child : Children)
+			{
+				AppendChain(Pending, Continuations, Child, Depth + 1, Out);
+			}
+		}
+
+		static bool TickStallWatchdog(const float DeltaTime)
+		{
+			const float StallSeconds = CVarStallSeconds.GetValueOnGameThread();
+			if (StallSeconds > 0.0f && FPromiseRegistry::Get().MarkStalled(StallSeconds) > 0)
+			{
+				TArray<FString> Lines;
+				DescribePendingPromises(StallSeconds).ParseIntoArrayLines(Lines);
+				for (const FString& Line : Lines)
+				{
+					UE_LOG(LogAsyncFutures, Warning, TEXT("%s"), *Line);
+				}
+			}
+			return true;
+		}
+
+		static void OnStallSecondsChanged(IConsoleVariable* Variable)
+		{
+			static FTSTicker::FDelegateHandle WatchdogHandle;
+			if (Variable->GetFloat() > 0.0f && !WatchdogHandle.IsValid())
+			{
+				WatchdogHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&TickStallWatchdog), 1.0f);
+			}
+			else if (Variable->GetFloat() <= 0.0f && WatchdogHandle.IsValid())
+			{
+				FTSTicker::GetCoreTicker().RemoveTicker(WatchdogHandle);
+				WatchdogHandle.Reset();
+			}
+		}
+
+		static FAutoConsoleCommandWithWorldArgsAndOutputDevice PromisesCommand(
+			TEXT("AsyncFutures.Promises"),
+			TEXT("Prints the sites with the oldest unfulfilled promises, and how many promises each site has broken. Optionally takes how many to print, 20 by default. Needs AsyncFutures.Promises.Track to be set."),
+			FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld*, FOutputDevice& Output)
+			{
+				const int32 MaxSites = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 20;
+				const TArray<FPromiseLeakStats> Report = GetPromiseLeakReport();
+				Output.Logf(TEXT("Broken promises: %llu"), GetNumBrokenPromises());
+				Output.Logf(TEXT("%-12s %-12s %-10s %s"), TEXT("Oldest (s)"), TEXT("Outstanding"), TEXT("Broken"), TEXT("Created at"));
+				for (int32 Index = 0; Index < FMath::Min(MaxSites, Report.Num()); ++Index)
+				{
+					const FPromiseLeakStats& Stats = Report[Index];
+					Output.Logf(TEXT("%-12.2f %-12llu %-10llu %s(%d)"), Stats.OldestSeconds, Stats.Outstanding, Stats.Broken, *Stats.File, Stats.Line);
+				}
+			}));
+
+		static FAutoConsoleCommandWithWorldArgsAndOutputDevice PendingPromisesCommand(
+			TEXT("AsyncFutures.Promises.Pending"),
+			TEXT("Prints the promises that have been waiting on a value for longer than the given number of seconds, 0 by default, with the continuations waiting on each. Needs AsyncFutures.Promises.Track or AsyncFutures.Promises.StallSeconds to be set."),
+			FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld*, FOutputDevice& Output)
+			{
+				TArray<FString> Lines;
+				DescribePendingPromises(Args.Num() > 0 ? FCString::Atod(*Args[0]) : 0.0).ParseIntoArrayLines(Lines);
+				for (const FString& Line : Lines)
+				{
+					Output.Log(Line);
+				}
+			}));
+
+		uint64 TrackPromise(const FCallSite& CallSite)
+		{
+			const bool bTrack = CVarTrackPromises.GetValueOnAnyThread() || CVarStallSeconds.GetValueOnAnyThread() > 0.0f;
+			return bTrack ? FPromiseRegistry::Get().Track(CallSite) : 0;
+		}
+
+		void DescribeTrackedPromise(const uint64 TrackingId, const uint64 WaitingOn, const FOptions& Options)
+		{
+			FPromiseRegistry::Get().Describe(TrackingId, WaitingOn, Options);
+		}
+
+		void RelinkTrackedPromise(const uint64 TrackingId, const uint64 WaitingOn)
+		{
+			FPromiseRegistry::Get().Relink(TrackingId, WaitingOn);
+		}
+
+		void UntrackPromise(const uint64 TrackingId)
+		{
+			if (TrackingId != 0)
+			{
+				FPromiseRegistry::Get().Untrack(TrackingId);
+			}
+		}
+
+		bool ReportBrokenPromise(const uint64 TrackingId)
+		{
+			const uint64 Total = ++NumBrokenPromises;
+
+			FString Site = TEXT("an untracked site (set AsyncFutures.Promises.Track to record it)");
+			double Age = 0.0;
+			const uint64 SiteTotal = TrackingId != 0 ? FPromiseRegistry::Get().Break(TrackingId, Site, Age) : 0;
+
+			const int32 Mode = CVarBrokenPromises.GetValueOnAnyThread();
+			checkf(Mode < 3, TEXT("Promise created at %s was dropped without being fulfilled after %.2fs"), *Site, Age);
+
+			//Only warn on powers of two so a site that leaks every frame doesn't flood the log
+			const uint64 Count = SiteTotal != 0 ? SiteTotal : Total;
+			if (Mode >= 1 && FMath::IsPowerOfTwo(Count))
+			{
+				UE_LOG(LogAsyncFutures, Warning, TEXT("Promise created at %s was dropped without being fulfilled after %.2fs (%llu broken from there, %llu in total)"),
+					*Site, Age, SiteTotal, Total);
+			}
+			return Mode >= 2;
+		}
+	}
+
+	TArray<FPromiseLeakStats> GetPromiseLeakReport()
+	{
+		return Private::FPromiseRegistry::Get().GetReport();
+	}
+
+	uint64 GetNumBrokenPromises()
+	{
+		return Private::NumBrokenPromises.load();
+	}
+
+	TArray<FPendingPromise> GetPendingPromises(const double MinAgeSeconds)
+	{
+		return Private::FPromiseRegistry::Get().GetPending(MinAgeSeconds);
+	}
+
+	FString DescribePendingPromises(const double MinAgeSeconds)
+	{
+		const TArray<FPendingPromise> Pending = GetPendingPromises(MinAgeSeconds);
+		FString Out = FString::Printf(TEXT("%d promises pending for at least %.2fs\n"), Pending.Num(), MinAgeSeconds);
+
+		TMap<uint64, int32> IndexById;
+		for (int32 Index = 0; Index < Pending.Num(); ++Index)
+		{
+			IndexById.Add(Pending[Index].Id, Index);
+		}
+
+		TMultiMap<uint64, int32> Continuations;
+		for (int32 Index = 0; Index < Pending.Num(); ++Index)
+		{
+			if (IndexById.Contains(Pending[Index].WaitingOn))
+			{
+				Continuations.Add(Pending[Index].WaitingOn, Index);
+			}
+		}
+
+		//Each chain starts at the promise holding it up, which isn't waiting on another pending promise
+		for (int32 Index = 0; Index < Pending.Num(); ++Index)
+		{
+			const FPendingPromise& Promise = Pending[Index];
+			if (IndexById.Contains(Promise.WaitingOn))
+			{
+				continue;
+			}
+
+			if (Promise.WaitingOn != 0)
+			{
+				Out += TEXT("Ready, queued or running:\n");
+			}
+			else if (Promise.Target.IsEmpty())
+			{
+				Out += TEXT("Waiting to be fulfilled:\n");
+			}
+			else
+			{
+				Out += TEXT("Waiting on an untracked promise:\n");
+			}
+			Private::AppendChain(Pending, Continuations, Index, 0, Out);
+		}
+		return Out;
+	}
+}
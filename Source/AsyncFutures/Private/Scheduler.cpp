@@ -0,0 +1,585 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include "Scheduler.h"
+
+// Engine Includes
+#include "Async/Async.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Containers/Queue.h"
+#include "HAL/Event.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "Misc/Fork.h"
+#include "Misc/QueuedThreadPool.h"
+#include "Misc/ScopeLock.h"
+#include "Tasks/Task.h"
+
+// Module Includes
+#include "AsyncFuture.h"
+#include "Metrics.h"
+
+namespace UE::Tasks::Private
+{
+	static TAutoConsoleVariable<float> CVarPriorityAgingInterval(
+		TEXT("AsyncFutures.Priority.AgingInterval"),
+		0.05f,
+		TEXT("Seconds a prioritised task waits in the queue before it competes one priority level higher, so background work is never starved."),
+		ECVF_Default);
+
+	static TAutoConsoleVariable<int32> CVarFusionMaxDepth(
+		TEXT("AsyncFutures.Fusion.MaxDepth"),
+		16,
+		TEXT("How many continuations may run straight after the stage they depend on, on the same thread, before one is scheduled again. 0 disables fusion."),
+		ECVF_Default);
+
+	static TAutoConsoleVariable<int32> CVarBackend(
+		TEXT("AsyncFutures.Backend"),
+		0,
+		TEXT("What runs TaskGraph work that isn't for a named thread. Set it per project under [ConsoleVariables] in DefaultEngine.ini.\n")
+		TEXT("0: Taskgraph tasks\n")
+		TEXT("1: UE::Tasks::Launch"),
+		ECVF_Default);
+
+	static TAutoConsoleVariable<int32> CVarMaxDedicatedThreads(
+		TEXT("AsyncFutures.Threads.Max"),
+		32,
+		TEXT("Most threads kept for EAsyncExecution::Thread work, and separately for ThreadIfForkSafe work. While they're all busy, more work gets a thread of its own that exits when the work is done. 0 creates a thread for every piece of work."),
+		ECVF_Default);
+
+	static TAutoConsoleVariable<float> CVarDedicatedThreadIdleSeconds(
+		TEXT("AsyncFutures.Threads.IdleSeconds"),
+		30.0f,
+		TEXT("How long a kept thread waits for more EAsyncExecution::Thread work before it exits."),
+		ECVF_Default);
+
+	static thread_local const FExecutionContext* CurrentContext = nullptr;
+
+	static ENamedThreads::Type ApplyPriority(const ENamedThreads::Type Thread, const EAsyncPriority Priority)
+	{
+		const ENamedThreads::Type ThreadAndQueue = ENamedThreads::Type(Thread & ~(ENamedThreads::ThreadPriorityMask | ENamedThreads::TaskPriorityMask));
+		switch (Priority)
+		{
+		case EAsyncPriority::Critical:
+			return ENamedThreads::Type(ThreadAndQueue | ENamedThreads::HighThreadPriority | ENamedThreads::HighTaskPriority);
+		case EAsyncPriority::High:
+			return ENamedThreads::Type(ThreadAndQueue | ENamedThreads::HighThreadPriority | ENamedThreads::NormalTaskPriority);
+		case EAsyncPriority::Background:
+			return ENamedThreads::Type(ThreadAndQueue | ENamedThreads::BackgroundThreadPriority | ENamedThreads::NormalTaskPriority);
+		default:
+			return ENamedThreads::Type(ThreadAndQueue | ENamedThreads::NormalThreadPriority | ENamedThreads::NormalTaskPriority);
+		}
+	}
+
+	static EQueuedWorkPriority ToQueuedWorkPriority(const TOptional<EAsyncPriority>& Priority)
+	{
+		switch (Priority.Get(EAsyncPriority::Normal))
+		{
+		case EAsyncPriority::Critical:		return EQueuedWorkPriority::Highest;
+		case EAsyncPriority::High:			return EQueuedWorkPriority::High;
+		case EAsyncPriority::Background:	return EQueuedWorkPriority::Low;
+		default:							return EQueuedWorkPriority::Normal;
+		}
+	}
+
+	static UE::Tasks::ETaskPriority ToTaskPriority(const ENamedThreads::Type Thread)
+	{
+		const bool bHighTaskPriority = ENamedThreads::GetTaskPriority(Thread) == ENamedThreads::HighTaskPriority;
+		switch (Thread & ENamedThreads::ThreadPriorityMask)
+		{
+		case ENamedThreads::HighThreadPriority:			return UE::Tasks::ETaskPriority::High;
+		case ENamedThreads::BackgroundThreadPriority:	return bHighTaskPriority ? UE::Tasks::ETaskPriority::BackgroundHigh : UE::Tasks::ETaskPriority::BackgroundNormal;
+		default:										return UE::Tasks::ETaskPriority::Normal;
+		}
+	}
+
+	//Dispatched work, with when it was scheduled. Executors hold it as it is and record its latency and run time around it when it runs,
+	//rather than it being wrapped in another function, which would be another allocation for every task
+	struct FDispatchedWork
+	{
+		FDispatchedWork() = default;
+		explicit FDispatchedWork(TUniqueFunction<void()>&& InWork)
+			: Work(MoveTemp(InWork))
+			, ScheduledCycles(FPlatformTime::Cycles64())
+		{
+		}
+
+		void operator()()
+		{
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			RecordStarted(ScheduledCycles, StartCycles);
+			Work();
+			RecordFinished(StartCycles, FPlatformTime::Cycles64());
+		}
+
+		explicit operator bool() const { return (bool)Work; }
+
+		TUniqueFunction<void()> Work;
+		uint64 ScheduledCycles = 0;
+	};
+
+	//Holds its body in the graph task's own allocation, like UE::Tasks::Launch does
+	template<typename F>
+	class TDispatchedGraphTask
+	{
+	public:
+		TDispatchedGraphTask(F&& InBody, const TStatId InStatId, const ENamedThreads::Type InThread)
+			: Body(MoveTemp(InBody))
+			, StatId(InStatId)
+			, Thread(InThread)
+		{
+		}
+
+		TStatId GetStatId() const { return StatId; }
+		ENamedThreads::Type GetDesiredThread() const { return Thread; }
+		static ESubsequentsMode::Type GetSubsequentsMode() { return ESubsequentsMode::FireAndForget; }
+
+		void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& CompletionGraphEvent)
+		{
+			Body();
+		}
+
+	private:
+		F Body;
+		const TStatId StatId;
+		const ENamedThreads::Type Thread;
+	};
+
+	//Runs work on the taskgraph thread, with the thread and task priority bits of the thread, through whichever backend is selected.
+	//Named threads only have taskgraph queues, so they always get a graph task
+	template<typename F>
+	static void LaunchOnTaskGraph(const ENamedThreads::Type Thread, const TCHAR* Name, const TStatId StatId, F&& Body)
+	{
+		if (GetBackend() == EAsyncBackend::Tasks && ENamedThreads::GetThreadIndex(Thread) == ENamedThreads::AnyThread)
+		{
+			UE::Tasks::Launch(Name != nullptr ? Name : TEXT("AsyncFutures"), MoveTemp(Body), ToTaskPriority(Thread));
+		}
+		else
+		{
+			TGraphTask<TDispatchedGraphTask<F>>::CreateTask().ConstructAndDispatchWhenReady(MoveTemp(Body), StatId, Thread);
+		}
+	}
+
+	//Same as Async.h's TAsyncQueuedWork, without the promise
+	class FDispatchedQueuedWork : public IQueuedWork
+	{
+	public:
+		explicit FDispatchedQueuedWork(FDispatchedWork&& InWork) : Work(MoveTemp(InWork)) {}
+
+		virtual void DoThreadedWork() override
+		{
+			Work();
+			delete this;
+		}
+
+		virtual void Abandon() override
+		{
+			//Not supported, same as TAsyncQueuedWork
+		}
+
+	private:
+		FDispatchedWork Work;
+	};
+
+	//Priority ordered queues in front of the taskgraph. Every enqueued item dispatches one pump, and each pump runs whichever waiting item
+	//has the best effective priority when it starts. An item's effective priority improves the longer it waits, so nothing waits forever.
+	class FPriorityScheduler
+	{
+		struct FItem
+		{
+			FDispatchedWork Work;
+			double EnqueueTime = 0.0;
+		};
+
+		static constexpr int32 NumPriorities = (int32)EAsyncPriority::Background + 1;
+
+		struct FQueues
+		{
+			TQueue<FItem> Levels[NumPriorities];
+		};
+
+	public:
+		static FPriorityScheduler& Get()
+		{
+			static FPriorityScheduler Scheduler;
+			return Scheduler;
+		}
+
+		void Enqueue(const ENamedThreads::Type Thread, const EAsyncPriority Priority, const TStatId StatId, FDispatchedWork&& Work)
+		{
+			//Items are shared between all pumps of the same thread, regardless of the priority bits they were dispatched with
+			const ENamedThreads::Type Queue = ENamedThreads::Type(Thread & ~(ENamedThreads::ThreadPriorityMask | ENamedThreads::TaskPriorityMask));
+			check((int32)Priority >= 0 && (int32)Priority < NumPriorities);
+			{
+				FScopeLock Lock(&CriticalSection);
+				TUniquePtr<FQueues>& Queues = QueuesByThread.FindOrAdd(Queue);
+				if (!Queues.IsValid())
+				{
+					Queues = MakeUnique<FQueues>();
+				}
+				Queues->Levels[(int32)Priority].Enqueue(FItem{ MoveTemp(Work), FPlatformTime::Seconds() });
+			}
+
+			LaunchOnTaskGraph(ApplyPriority(Thread, Priority), nullptr, StatId, [this, Queue]() { RunNext(Queue); });
+		}
+
+	private:
+		void RunNext(const ENamedThreads::Type Queue)
+		{
+			FItem Item;
+			{
+				FScopeLock Lock(&CriticalSection);
+				FQueues& Queues = *QueuesByThread.FindChecked(Queue);
+
+				const double Now = FPlatformTime::Seconds();
+				const double AgingInterval = FMath::Max((double)CVarPriorityAgingInterval.GetValueOnAnyThread(), UE_SMALL_NUMBER);
+
+				int32 BestLevel = INDEX_NONE;
+				double BestRank = 0.0;
+				double BestEnqueueTime = 0.0;
+				for (int32 Level = 0; Level < NumPriorities; ++Level)
+				{
+					//Queues are FIFO so the head is always the oldest, and therefore best ranked, item of its level
+					const FItem* Head = Queues.Levels[Level].Peek();
+					if (Head == nullptr)
+					{
+						continue;
+					}
+
+					const double Rank = FMath::Max(0.0, Level - (Now - Head->EnqueueTime) / AgingInterval);
+					if (BestLevel == INDEX_NONE || Rank < BestRank || (Rank == BestRank && Head->EnqueueTime < BestEnqueueTime))
+					{
+						BestLevel = Level;
+						BestRank = Rank;
+						BestEnqueueTime = Head->EnqueueTime;
+					}
+				}
+
+				check(BestLevel != INDEX_NONE); //Every item dispatches exactly one pump
+				Queues.Levels[BestLevel].Dequeue(Item);
+			}
+
+			Item.Work();
+		}
+
+		FCriticalSection CriticalSection;
+		TMap<ENamedThreads::Type, TUniquePtr<FQueues>> QueuesByThread;
+	};
+
+	//Threads that each run one piece of work at a time and then wait for more, so blocking work doesn't create and tear down a thread every time.
+	//Work never waits for a kept thread to be free, so work that blocks on other work on these threads can't deadlock.
+	class FDedicatedThreadPool
+	{
+		class FWorker : public FRunnable
+		{
+		public:
+			FWorker(FDedicatedThreadPool& InPool, FDispatchedWork&& InWork)
+				: Pool(InPool)
+				, Work(MoveTemp(InWork))
+			{
+			}
+
+			virtual ~FWorker() override
+			{
+				FPlatformProcess::ReturnSynchEventToPool(Wake);
+			}
+
+			virtual uint32 Run() override
+			{
+				do
+				{
+					Work();
+					Work = FDispatchedWork();
+				} while (Pool.WaitForWork(*this));
+				return 0;
+			}
+
+			FDedicatedThreadPool& Pool;
+			FDispatchedWork Work;
+			FEvent* Wake = FPlatformProcess::GetSynchEventFromPool(false);
+			FRunnableThread* Thread = nullptr;
+		};
+
+	public:
+		explicit FDedicatedThreadPool(const bool bInForkable)
+			: bForkable(bInForkable)
+			, ProcessId(FPlatformProcess::GetCurrentProcessId())
+		{
+		}
+
+		void Run(FDispatchedWork&& Work)
+		{
+			{
+				FScopeLock Lock(&CriticalSection);
+				if (ProcessId != FPlatformProcess::GetCurrentProcessId())
+				{
+					//Only the forking thread survives a fork, the kept threads belong to the parent
+					ProcessId = FPlatformProcess::GetCurrentProcessId();
+					Idle.Reset();
+					NumThreads = 0;
+				}
+
+				if (Idle.Num() > 0)
+				{
+					FWorker* Worker = Idle.Pop();
+					Worker->Work = MoveTemp(Work);
+					Worker->Wake->Trigger();
+					return;
+				}
+
+				if (!bStopping && NumThreads < CVarMaxDedicatedThreads.GetValueOnAnyThread())
+				{
+					//Created under the lock so the worker can't retire before it knows its thread
+					++NumThreads;
+					FWorker* Worker = new FWorker(*this, MoveTemp(Work));
+					Worker->Thread = CreateThread(Worker);
+					return;
+				}
+			}
+
+			TPromise<FRunnableThread*> ThreadPromise;
+			TAsyncRunnable<void>* Runnable = new TAsyncRunnable<void>([Work = MoveTemp(Work)]() mutable { Work(); }, TPromise<void>(), ThreadPromise.GetFuture());
+			ThreadPromise.SetValue(CreateThread(Runnable));
+		}
+
+		//Wakes the kept threads that are waiting so they exit, busy ones exit once they're done
+		void Stop()
+		{
+			FScopeLock Lock(&CriticalSection);
+			bStopping = true;
+			for (FWorker* Worker : Idle)
+			{
+				Worker->Wake->Trigger();
+			}
+			Idle.Reset();
+		}
+
+	private:
+		FRunnableThread* CreateThread(FRunnable* Runnable) const
+		{
+			const FString Name = FString::Printf(TEXT("TAsync %d"), FAsyncThreadIndex::GetNext());
+			FRunnableThread* RunnableThread = bForkable ? FForkProcessHelper::CreateForkableThread(Runnable, *Name) : FRunnableThread::Create(Runnable, *Name);
+
+			check(RunnableThread != nullptr);
+			check(RunnableThread->GetThreadType() == FRunnableThread::ThreadType::Real);
+			return RunnableThread;
+		}
+
+		//Returns false when the worker should exit instead
+		bool WaitForWork(FWorker& Worker)
+		{
+			{
+				FScopeLock Lock(&CriticalSection);
+				if (bStopping)
+				{
+					Retire(Worker);
+					return false;
+				}
+				Idle.Push(&Worker);
+			}
+
+			const uint32 IdleMs = uint32(FMath::Max(CVarDedicatedThreadIdleSeconds.GetValueOnAnyThread(), 0.0f) * 1000.0f);
+			if (!Worker.Wake->Wait(IdleMs))
+			{
+				{
+					FScopeLock Lock(&CriticalSection);
+					if (Idle.Remove(&Worker) > 0)
+					{
+						Retire(Worker);
+						return false;
+					}
+				}
+				//Claimed just as it timed out, the wake is already on its way
+				Worker.Wake->Wait();
+			}
+
+			//Woken without work when stopping
+			if (!Worker.Work)
+			{
+				FScopeLock Lock(&CriticalSection);
+				Retire(Worker);
+				return false;
+			}
+			return true;
+		}
+
+		//A thread can't destroy itself, so the worker and its thread are cleaned up from the taskgraph once it has exited
+		void Retire(FWorker& Worker)
+		{
+			--NumThreads;
+			FWorker* Retired = &Worker;
+			FFunctionGraphTask::CreateAndDispatchWhenReady([Retired]()
+			{
+				delete Retired->Thread;
+				delete Retired;
+			}, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
+		}
+
+		const bool bForkable;
+		FCriticalSection CriticalSection;
+		TArray<FWorker*> Idle;
+		int32 NumThreads = 0;
+		uint32 ProcessId = 0;
+		bool bStopping = false;
+	};
+
+	//Never destroyed, work can still be dispatched by other statics during shutdown
+	static FDedicatedThreadPool& GetDedicatedThreads(const bool bForkable)
+	{
+		static FDedicatedThreadPool* Threads = new FDedicatedThreadPool(false);
+		static FDedicatedThreadPool* ForkableThreads = new FDedicatedThreadPool(true);
+		return bForkable ? *ForkableThreads : *Threads;
+	}
+
+	void Dispatch(const FOptions& Options, TUniqueFunction<void()>&& InWork)
+	{
+		const TOptional<EAsyncPriority> Priority = Options.GetPriority();
+		const TStatId StatId = Options.GetStatId();
+
+		RecordScheduled(Options.GetExecutionPolicy());
+		FDispatchedWork Work(MoveTemp(InWork));
+
+		//Copied from Async.h to allow us to pass the thread to the task graph
+		switch (Options.GetExecutionPolicy())
+		{
+		case EAsyncExecution::TaskGraphMainThread:
+			if (Priority.IsSet())
+			{
+				FPriorityScheduler::Get().Enqueue(ENamedThreads::GameThread, Priority.GetValue(), StatId, MoveTemp(Work));
+			}
+			else
+			{
+				LaunchOnTaskGraph(ENamedThreads::GameThread, Options.GetName(), StatId, MoveTemp(Work));
+			}
+			break;
+
+		case EAsyncExecution::TaskGraph:
+			if (Priority.IsSet())
+			{
+				FPriorityScheduler::Get().Enqueue(Options.GetDesiredThread(), Priority.GetValue(), StatId, MoveTemp(Work));
+			}
+			else
+			{
+				//Graph tasks carry the options' stat, so they show up under it rather than as anonymous tasks
+				LaunchOnTaskGraph(Options.GetDesiredThread(), Options.GetName(), StatId, MoveTemp(Work));
+			}
+			break;
+
+		case EAsyncExecution::Thread:
+			if (FPlatformProcess::SupportsMultithreading())
+			{
+				GetDedicatedThreads(false).Run(MoveTemp(Work));
+			}
+			else
+			{
+				Work();
+			}
+			break;
+
+		case EAsyncExecution::ThreadIfForkSafe:
+			if (FPlatformProcess::SupportsMultithreading() || FForkProcessHelper::IsForkedMultithreadInstance())
+			{
+				GetDedicatedThreads(true).Run(MoveTemp(Work));
+			}
+			else
+			{
+				Work();
+			}
+			break;
+
+		case EAsyncExecution::ThreadPool:
+			if (FPlatformProcess::SupportsMultithreading())
+			{
+				check(GThreadPool != nullptr);
+				GThreadPool->AddQueuedWork(new FDispatchedQueuedWork(MoveTemp(Work)), ToQueuedWorkPriority(Priority));
+			}
+			else
+			{
+				Work();
+			}
+			break;
+
+#if WITH_EDITOR
+		case EAsyncExecution::LargeThreadPool:
+			if (FPlatformProcess::SupportsMultithreading())
+			{
+				check(GLargeThreadPool != nullptr);
+				GLargeThreadPool->AddQueuedWork(new FDispatchedQueuedWork(MoveTemp(Work)), ToQueuedWorkPriority(Priority));
+			}
+			else
+			{
+				Work();
+			}
+			break;
+#endif
+
+		default:
+			check(false); // not implemented!
+		}
+	}
+
+	EAsyncBackend GetBackend()
+	{
+		return CVarBackend.GetValueOnAnyThread() == 1 ? EAsyncBackend::Tasks : EAsyncBackend::TaskGraph;
+	}
+
+	void StopDedicatedThreads()
+	{
+		GetDedicatedThreads(false).Stop();
+		GetDedicatedThreads(true).Stop();
+	}
+
+	int32 GetConcurrency(const FOptions& Options)
+	{
+		if (!FPlatformProcess::SupportsMultithreading())
+		{
+			return 1;
+		}
+
+		switch (Options.GetExecutionPolicy())
+		{
+		case EAsyncExecution::TaskGraphMainThread:
+			return 1;
+
+		case EAsyncExecution::TaskGraph:
+			if (ENamedThreads::GetThreadIndex(Options.GetDesiredThread()) != ENamedThreads::AnyThread)
+			{
+				return 1; //Named threads run their queue one item at a time
+			}
+			return FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1);
+
+		case EAsyncExecution::ThreadPool:
+			return FMath::Max(GThreadPool->GetNumThreads(), 1);
+
+#if WITH_EDITOR
+		case EAsyncExecution::LargeThreadPool:
+			return FMath::Max(GLargeThreadPool->GetNumThreads(), 1);
+#endif
+
+		default:
+			return FMath::Max(FPlatformMisc::NumberOfCoresIncludingHyperthreads(), 1);
+		}
+	}
+
+	FExecutionScope::FExecutionScope(const FOptions& Options, const void* Fulfilling)
+		: Context{ Options.GetExecutionPolicy(), Options.GetDesiredThread(), Options.GetPriority(), CurrentContext != nullptr ? CurrentContext->Depth + 1 : 0, Fulfilling }
+		, Previous(CurrentContext)
+	{
+		CurrentContext = &Context;
+	}
+
+	FExecutionScope::~FExecutionScope()
+	{
+		CurrentContext = Previous;
+	}
+
+	bool CanRunInline(const FOptions& Options, const void* Fulfilled)
+	{
+		const FExecutionContext* Context = CurrentContext;
+		return Context != nullptr
+			&& Context->Fulfilling == Fulfilled
+			&& Context->Depth < CVarFusionMaxDepth.GetValueOnAnyThread()
+			&& Context->Execution == Options.GetExecutionPolicy()
+			&& Context->Thread == Options.GetDesiredThread()
+			&& Context->Priority == Options.GetPriority();
+	}
+}
@@ -0,0 +1,80 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include "Timer.h"
+
+// Engine Includes
+#include "Containers/Ticker.h"
+#include "Misc/ScopeLock.h"
+
+namespace UE::Tasks::Private
+{
+	class FTimerQueue
+	{
+		struct FTimer
+		{
+			double Deadline;
+			TAsyncPromise<void> Promise;
+		};
+
+		struct FEarliestFirst
+		{
+			bool operator()(const FTimer& A, const FTimer& B) const { return A.Deadline < B.Deadline; }
+		};
+
+	public:
+		static FTimerQueue& Get()
+		{
+			static FTimerQueue Queue;
+			return Queue;
+		}
+
+		void Add(const double DelayInSeconds, const TAsyncPromise<void>& Promise)
+		{
+			FScopeLock Lock(&CriticalSection);
+			Timers.HeapPush(FTimer{ FPlatformTime::Seconds() + DelayInSeconds, Promise }, FEarliestFirst());
+
+			//Only ticks while there are timers waiting
+			if (!TickerHandle.IsValid())
+			{
+				TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FTimerQueue::Tick));
+			}
+		}
+
+	private:
+		bool Tick(const float DeltaTime)
+		{
+			TArray<TAsyncPromise<void>> Due;
+			bool bKeepTicking = false;
+			{
+				FScopeLock Lock(&CriticalSection);
+				const double Now = FPlatformTime::Seconds();
+				while (Timers.Num() > 0 && Timers.HeapTop().Deadline <= Now)
+				{
+					Due.Add(Timers.HeapTop().Promise);
+					Timers.HeapPopDiscard(FEarliestFirst());
+				}
+
+				bKeepTicking = Timers.Num() > 0;
+				if (!bKeepTicking)
+				{
+					TickerHandle.Reset();
+				}
+			}
+
+			//Fulfil outside the lock as this runs the continuations
+			for (const TAsyncPromise<void>& Promise : Due)
+			{
+				Promise.SetValue();
+			}
+			return bKeepTicking;
+		}
+
+		FCriticalSection CriticalSection;
+		TArray<FTimer> Timers;
+		FTSTicker::FDelegateHandle TickerHandle;
+	};
+
+	void StartTimer(const double DelayInSeconds, const TAsyncPromise<void>& Promise)
+	{
+		FTimerQueue::Get().Add(DelayInSeconds, Promise);
+	}
+}
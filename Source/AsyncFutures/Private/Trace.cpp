@@ -0,0 +1,125 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include "Trace.h"
+#include <atomic>
+
+#if ASYNCFUTURES_TRACE_ENABLED
+
+// Engine Includes
+#include "HAL/PlatformTime.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+UE_TRACE_CHANNEL_DEFINE(AsyncFuturesChannel)
+
+UE_TRACE_EVENT_BEGIN(AsyncFutures, PromiseCreated)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, PromiseId)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(AsyncFutures, PromiseFulfilled)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, PromiseId)
+	UE_TRACE_EVENT_FIELD(bool, Error)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(AsyncFutures, ContinuationScheduled)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, AntecedentId)
+	UE_TRACE_EVENT_FIELD(uint64, PromiseId)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, Name)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(AsyncFutures, ContinuationStarted)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, PromiseId)
+	UE_TRACE_EVENT_FIELD(uint32, ThreadId)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(AsyncFutures, ContinuationEnded)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint64, PromiseId)
+UE_TRACE_EVENT_END()
+
+namespace UE::Tasks::Private
+{
+	static std::atomic<uint64> NextTracedPromiseId = 1;
+
+	uint64 TracePromiseCreated()
+	{
+		if (!UE_TRACE_CHANNELEXPR_IS_ENABLED(AsyncFuturesChannel))
+		{
+			return 0;
+		}
+
+		const uint64 PromiseId = NextTracedPromiseId++;
+		UE_TRACE_LOG(AsyncFutures, PromiseCreated, AsyncFuturesChannel)
+			<< PromiseCreated.Cycle(FPlatformTime::Cycles64())
+			<< PromiseCreated.PromiseId(PromiseId);
+		return PromiseId;
+	}
+
+	void TracePromiseFulfilled(const uint64 PromiseId, const bool bError)
+	{
+		if (PromiseId == 0)
+		{
+			return;
+		}
+
+		UE_TRACE_LOG(AsyncFutures, PromiseFulfilled, AsyncFuturesChannel)
+			<< PromiseFulfilled.Cycle(FPlatformTime::Cycles64())
+			<< PromiseFulfilled.PromiseId(PromiseId)
+			<< PromiseFulfilled.Error(bError);
+	}
+
+	void TraceContinuationScheduled(const uint64 AntecedentId, const uint64 PromiseId, const TCHAR* Name)
+	{
+		if (PromiseId == 0)
+		{
+			return;
+		}
+
+		UE_TRACE_LOG(AsyncFutures, ContinuationScheduled, AsyncFuturesChannel)
+			<< ContinuationScheduled.Cycle(FPlatformTime::Cycles64())
+			<< ContinuationScheduled.AntecedentId(AntecedentId)
+			<< ContinuationScheduled.PromiseId(PromiseId)
+			<< ContinuationScheduled.Name(Name != nullptr ? Name : TEXT(""));
+	}
+
+	bool TraceContinuationStarted(const uint64 PromiseId, const TCHAR* Name)
+	{
+		if (PromiseId != 0)
+		{
+			UE_TRACE_LOG(AsyncFutures, ContinuationStarted, AsyncFuturesChannel)
+				<< ContinuationStarted.Cycle(FPlatformTime::Cycles64())
+				<< ContinuationStarted.PromiseId(PromiseId)
+				<< ContinuationStarted.ThreadId(FPlatformTLS::GetCurrentThreadId());
+		}
+
+#if CPUPROFILERTRACE_ENABLED
+		if (Name != nullptr && UE_TRACE_CHANNELEXPR_IS_ENABLED(CpuChannel))
+		{
+			FCpuProfilerTrace::OutputBeginDynamicEvent(Name);
+			return true;
+		}
+#endif
+		return false;
+	}
+
+	void TraceContinuationEnded(const uint64 PromiseId, const bool bNamedSpan)
+	{
+		if (PromiseId != 0)
+		{
+			UE_TRACE_LOG(AsyncFutures, ContinuationEnded, AsyncFuturesChannel)
+				<< ContinuationEnded.Cycle(FPlatformTime::Cycles64())
+				<< ContinuationEnded.PromiseId(PromiseId);
+		}
+
+#if CPUPROFILERTRACE_ENABLED
+		if (bNamedSpan)
+		{
+			FCpuProfilerTrace::OutputEndEvent();
+		}
+#endif
+	}
+}
+
+#endif
@@ -0,0 +1,198 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+#include <atomic>
+#include <type_traits>
+
+// Engine Includes
+#include "Containers/ArrayView.h"
+#include "Templates/UniquePtr.h"
+
+// Module Includes
+#include "AsyncFuture.h"
+#include "AsyncFutureHelpers.h"
+
+namespace UE::Tasks
+{
+	namespace Private
+	{
+		//Owns the inputs and every item's promise state, allocated together up front. A handful of pumps pull items off a shared index
+		//instead of each item being its own task.
+		template<typename InputType, typename ResultType, typename F>
+		class TBatchState : public TSharedFromThis<TBatchState<InputType, ResultType, F>, ESPMode::ThreadSafe>
+		{
+		public:
+			TBatchState(TArrayView<const InputType> InInputs, F&& InFunction)
+				: Inputs(InInputs)
+				, States(MakeUnique<TPromiseState<ResultType>[]>(InInputs.Num()))
+				, Remaining(InInputs.Num())
+				, Function(Forward<F>(InFunction))
+			{
+				if (Inputs.Num() == 0)
+				{
+					Completed.SetValue();
+				}
+			}
+
+			int32 Num() const { return Inputs.Num(); }
+
+			//Futures share ownership of the whole batch
+			TAsyncFuture<ResultType> GetFuture(const int32 Index)
+			{
+				return TAsyncFuture<ResultType>(TSharedRef<TPromiseState<ResultType>, ESPMode::ThreadSafe>(this->AsShared(), &States[Index]));
+			}
+
+			TAsyncFuture<void> GetCompletion() { return Completed.GetFuture(); }
+
+			void BindCancellation(FCancellationHandle Handle)
+			{
+				Handle.Bind(Completed);
+				typename TPromiseState<void>::FCallback OnCancelled = [WeakBatch = TWeakPtr<TBatchState, ESPMode::ThreadSafe>(this->AsShared())](const TResult<void>& Result)
+				{
+					const TSharedPtr<TBatchState, ESPMode::ThreadSafe> Batch = WeakBatch.Pin();
+					if (Batch.IsValid() && Result.IsCancelled())
+					{
+						Batch->CancelRemaining();
+					}
+				};
+				if (!Completed.State->AddCallback(MoveTemp(OnCancelled)))
+				{
+					OnCancelled(Completed.Get());
+				}
+			}
+
+			void Pump()
+			{
+				for (int32 Index = NextIndex++; Index < Num(); Index = NextIndex++)
+				{
+					//Items that were cancelled before their turn are skipped
+					TPromiseState<ResultType>& State = States[Index];
+					if (!State.IsSet())
+					{
+						if constexpr (std::is_void_v<ResultType>)
+						{
+							Function(Inputs[Index]);
+							State.SetValue(TResult<void>());
+						}
+						else
+						{
+							State.SetValue(TResult<ResultType>(Function(Inputs[Index])));
+						}
+					}
+
+					if (--Remaining == 0)
+					{
+						Completed.SetValue();
+					}
+				}
+			}
+
+			auto Collect() const
+			{
+				if constexpr (std::is_void_v<ResultType>)
+				{
+					for (int32 Index = 0; Index < Num(); ++Index)
+					{
+						const TResult<void> Result = States[Index].Get();
+						if (Result.HasError())
+						{
+							return Result;
+						}
+					}
+					return TResult<void>();
+				}
+				else
+				{
+					TArray<ResultType> Values;
+					Values.Reserve(Num());
+					for (int32 Index = 0; Index < Num(); ++Index)
+					{
+						const TResult<ResultType> Result = States[Index].Get();
+						if (Result.HasError())
+						{
+							return TResult<TArray<ResultType>>(Result.GetError());
+						}
+						Values.Add(Result.GetValue());
+					}
+					return TResult<TArray<ResultType>>(MoveTemp(Values));
+				}
+			}
+
+		private:
+			void CancelRemaining()
+			{
+				for (int32 Index = 0; Index < Num(); ++Index)
+				{
+					States[Index].SetValue(TResult<ResultType>(MakeCancelledError()));
+				}
+			}
+
+			const TArray<InputType> Inputs;
+			TUniquePtr<TPromiseState<ResultType>[]> States;
+			std::atomic<int32> NextIndex = 0;
+			std::atomic<int32> Remaining;
+			TAsyncPromise<void> Completed;
+			std::remove_cv_t<typename TRemoveReference<F>::Type> Function;
+		};
+
+		template<typename InputType, typename F>
+		using TBatchResult_T = TUnwrap_T<std::decay_t<std::invoke_result_t<F, const InputType&>>>;
+
+		template<typename InputType, typename F>
+		auto LaunchBatch(TArrayView<const InputType> Inputs, F&& Function, const FOptions& Options)
+		{
+			using ResultType = TBatchResult_T<InputType, F>;
+			static_assert(!TIsFuture<std::invoke_result_t<F, const InputType&>>::Value, "Batched functions must return a value or TResult, not a future.");
+
+			const auto Batch = MakeShared<TBatchState<InputType, ResultType, F>, ESPMode::ThreadSafe>(Inputs, Forward<F>(Function));
+			if (Options.GetCancellation().IsSet())
+			{
+				Batch->BindCancellation(Options.GetCancellation().GetValue());
+			}
+
+			//One dispatch per worker that can usefully run the batch, rather than one per item
+			const int32 NumPumps = FMath::Min(Batch->Num(), GetConcurrency(Options));
+			for (int32 i = 0; i < NumPumps; ++i)
+			{
+				Dispatch(Options, [Batch]() { Batch->Pump(); });
+			}
+			return Batch;
+		}
+	}
+
+	//Runs the function once for every input, as Async would, returning a future per input in the same order.
+	//The function is shared by every worker running the batch, so it may be called concurrently.
+	template<typename InputType, typename F>
+	auto AsyncBatch(TArrayView<const InputType> Inputs, F&& Function, const FOptions& Options = FOptions())
+	{
+		using ResultType = Private::TBatchResult_T<InputType, F>;
+		const auto Batch = Private::LaunchBatch(Inputs, Forward<F>(Function), Options);
+
+		TArray<TAsyncFuture<ResultType>> Futures;
+		Futures.Reserve(Batch->Num());
+		for (int32 Index = 0; Index < Batch->Num(); ++Index)
+		{
+			Futures.Add(Batch->GetFuture(Index));
+		}
+		return Futures;
+	}
+
+	template<typename InputType, typename F>
+	auto AsyncBatch(const TArray<InputType>& Inputs, F&& Function, const FOptions& Options = FOptions())
+	{
+		return AsyncBatch(TArrayView<const InputType>(Inputs), Forward<F>(Function), Options);
+	}
+
+	//As AsyncBatch, but completes once with every result in input order, or with the first error by input order
+	template<typename InputType, typename F>
+	auto AsyncBatchAll(TArrayView<const InputType> Inputs, F&& Function, const FOptions& Options = FOptions())
+	{
+		const auto Batch = Private::LaunchBatch(Inputs, Forward<F>(Function), Options);
+		return Batch->GetCompletion().Then([Batch](const TResult<void>&) { return Batch->Collect(); });
+	}
+
+	template<typename InputType, typename F>
+	auto AsyncBatchAll(const TArray<InputType>& Inputs, F&& Function, const FOptions& Options = FOptions())
+	{
+		return AsyncBatchAll(TArrayView<const InputType>(Inputs), Forward<F>(Function), Options);
+	}
+}
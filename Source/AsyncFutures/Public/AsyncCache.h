@@ -0,0 +1,223 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+#include <type_traits>
+
+// Engine Includes
+#include "Containers/List.h"
+#include "Containers/Map.h"
+#include "Misc/ScopeLock.h"
+#include "Templates/UniquePtr.h"
+
+// Module Includes
+#include "AsyncFuture.h"
+#include "AsyncFutureHelpers.h"
+
+namespace UE::Tasks
+{
+	namespace Private
+	{
+		template<typename K, typename V>
+		class TCacheState : public TSharedFromThis<TCacheState<K, V>, ESPMode::ThreadSafe>
+		{
+			using FLruList = TDoubleLinkedList<K>;
+
+			struct FEntry
+			{
+				TAsyncFuture<V> Future;
+				bool bCompleted = false;
+				int64 Cost = 0;
+				double ExpiryTime = 0.0;
+				typename FLruList::TDoubleLinkedListNode* LruNode = nullptr;
+			};
+
+			struct FShard
+			{
+				FCriticalSection CriticalSection;
+				TMap<K, TSharedRef<FEntry, ESPMode::ThreadSafe>> Entries;
+				FLruList Lru; //Completed entries only, most recently used at the head
+				int64 TotalCost = 0;
+			};
+
+		public:
+			TCacheState(const int64 InMaxCost, const double InTimeToLive, const int32 NumShards, TFunction<int64(const V&)>&& InCostFunction)
+				: MaxCostPerShard(FMath::Max<int64>(InMaxCost / NumShards, 1))
+				, TimeToLive(InTimeToLive)
+				, CostFunction(MoveTemp(InCostFunction))
+			{
+				for (int32 i = 0; i < NumShards; ++i)
+				{
+					Shards.Add(MakeUnique<FShard>());
+				}
+			}
+
+			template<typename F>
+			TAsyncFuture<V> GetOrCompute(const K& Key, F&& Factory)
+			{
+				FShard& Shard = GetShard(Key);
+				//Only made on a miss, a promise dropped on a hit would be reported as broken
+				TOptional<TAsyncPromise<V>> Promise;
+				TSharedPtr<FEntry, ESPMode::ThreadSafe> NewEntry;
+				{
+					FScopeLock Lock(&Shard.CriticalSection);
+					if (const TSharedRef<FEntry, ESPMode::ThreadSafe>* Existing = Shard.Entries.Find(Key))
+					{
+						FEntry& Entry = Existing->Get();
+						if (!Entry.bCompleted)
+						{
+							return Entry.Future; //Join the computation already in flight
+						}
+						if (TimeToLive <= 0.0 || FPlatformTime::Seconds() < Entry.ExpiryTime)
+						{
+							Shard.Lru.RemoveNode(Entry.LruNode, false);
+							Shard.Lru.AddHead(Entry.LruNode);
+							return Entry.Future;
+						}
+						RemoveLocked(Shard, Key);
+					}
+
+					Promise.Emplace();
+					NewEntry = MakeShared<FEntry, ESPMode::ThreadSafe>();
+					NewEntry->Future = Promise->GetFuture();
+					Shard.Entries.Add(Key, NewEntry.ToSharedRef());
+				}
+
+				//Run the factory outside the lock, callers for the same key in the meantime get the in-flight future
+				TAsyncFuture<V> Computed = Factory();
+				const TSharedRef<TPromiseState<V>, ESPMode::ThreadSafe> ComputedState = FFutureAccess::GetState(Computed);
+				typename TPromiseState<V>::FCallback OnComputed = [State = this->AsShared(), Key, Entry = NewEntry.ToSharedRef(), Promise = Promise.GetValue()](const TResult<V>& Result)
+				{
+					State->Complete(Key, Entry, Result);
+					Promise.SetValue(Result);
+				};
+				if (!ComputedState->AddCallback(MoveTemp(OnComputed)))
+				{
+					OnComputed(ComputedState->Get());
+				}
+				ComputedState->Start();
+
+				return NewEntry->Future;
+			}
+
+			void Remove(const K& Key)
+			{
+				FShard& Shard = GetShard(Key);
+				FScopeLock Lock(&Shard.CriticalSection);
+				RemoveLocked(Shard, Key);
+			}
+
+			void Empty()
+			{
+				for (const TUniquePtr<FShard>& Shard : Shards)
+				{
+					FScopeLock Lock(&Shard->CriticalSection);
+					Shard->Entries.Empty();
+					Shard->Lru.Empty();
+					Shard->TotalCost = 0;
+				}
+			}
+
+			int32 Num() const
+			{
+				int32 Count = 0;
+				for (const TUniquePtr<FShard>& Shard : Shards)
+				{
+					FScopeLock Lock(&Shard->CriticalSection);
+					Count += Shard->Entries.Num();
+				}
+				return Count;
+			}
+
+		private:
+			FShard& GetShard(const K& Key) const
+			{
+				return *Shards[GetTypeHash(Key) % (uint32)Shards.Num()];
+			}
+
+			void Complete(const K& Key, const TSharedRef<FEntry, ESPMode::ThreadSafe>& Entry, const TResult<V>& Result)
+			{
+				FShard& Shard = GetShard(Key);
+				FScopeLock Lock(&Shard.CriticalSection);
+
+				//The entry may have been removed or replaced while it was computing
+				const TSharedRef<FEntry, ESPMode::ThreadSafe>* Current = Shard.Entries.Find(Key);
+				if (Current == nullptr || &Current->Get() != &Entry.Get())
+				{
+					return;
+				}
+
+				//Errors aren't cached, the next caller tries again
+				if (Result.HasError())
+				{
+					Shard.Entries.Remove(Key);
+					return;
+				}
+
+				Entry->bCompleted = true;
+				Entry->Cost = CostFunction ? CostFunction(Result.GetValue()) : 1;
+				Entry->ExpiryTime = FPlatformTime::Seconds() + TimeToLive;
+				Shard.Lru.AddHead(Key);
+				Entry->LruNode = Shard.Lru.GetHead();
+				Shard.TotalCost += Entry->Cost;
+
+				while (Shard.TotalCost > MaxCostPerShard && Shard.Lru.Num() > 1)
+				{
+					const K Evicted = Shard.Lru.GetTail()->GetValue();
+					RemoveLocked(Shard, Evicted);
+				}
+			}
+
+			void RemoveLocked(FShard& Shard, const K& Key)
+			{
+				if (const TSharedRef<FEntry, ESPMode::ThreadSafe>* Entry = Shard.Entries.Find(Key))
+				{
+					if ((*Entry)->LruNode != nullptr)
+					{
+						Shard.TotalCost -= (*Entry)->Cost;
+						Shard.Lru.RemoveNode((*Entry)->LruNode);
+					}
+					Shard.Entries.Remove(Key);
+				}
+			}
+
+			const int64 MaxCostPerShard;
+			const double TimeToLive;
+			const TFunction<int64(const V&)> CostFunction;
+			TArray<TUniquePtr<FShard>> Shards;
+		};
+	}
+
+	//Copyable handle to a concurrent cache of asynchronously computed values. Callers asking for a key that's already being computed share the
+	//in-flight future instead of starting their own. Completed values are kept until they expire or the least recently used are evicted to
+	//stay within the cost budget, and errors are never kept.
+	template<typename K, typename V>
+	class TAsyncCache
+	{
+	public:
+		//A TimeToLive of zero or less keeps values until they're evicted. Without a cost function every value costs 1
+		TAsyncCache(const int64 MaxCost, const double TimeToLive = 0.0, const int32 NumShards = 16, TFunction<int64(const V&)> CostFunction = nullptr)
+			: State(MakeShared<Private::TCacheState<K, V>, ESPMode::ThreadSafe>(MaxCost, TimeToLive, FMath::Max(NumShards, 1), MoveTemp(CostFunction)))
+		{
+			check(MaxCost > 0);
+		}
+
+		TAsyncCache(const TAsyncCache& Other) = default;
+		TAsyncCache& operator=(const TAsyncCache& Other) = default;
+		TAsyncCache(TAsyncCache&& Other) = default;
+		TAsyncCache& operator=(TAsyncCache&& Other) = default;
+
+		//The factory returns a TAsyncFuture<V> and is only called when the key is neither cached nor being computed
+		template<typename F>
+		TAsyncFuture<V> GetOrCompute(const K& Key, F&& Factory) const
+		{
+			static_assert(std::is_same_v<std::decay_t<decltype(Factory())>, TAsyncFuture<V>>, "The factory needs to return a TAsyncFuture of the cached type.");
+			return State->GetOrCompute(Key, Forward<F>(Factory));
+		}
+
+		void Remove(const K& Key) const { State->Remove(Key); }
+		void Empty() const { State->Empty(); }
+		int32 Num() const { return State->Num(); }
+
+	private:
+		TSharedRef<Private::TCacheState<K, V>, ESPMode::ThreadSafe> State;
+	};
+}
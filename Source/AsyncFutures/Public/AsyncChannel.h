@@ -0,0 +1,360 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+#include <atomic>
+
+// Engine Includes
+#include "Containers/Queue.h"
+#include "Misc/ScopeLock.h"
+#include "Templates/UniquePtr.h"
+
+// Module Includes
+#include "AsyncFuture.h"
+#include "AsyncFutureHelpers.h"
+
+namespace UE::Tasks
+{
+	inline uint64 ERROR_CHANNEL_CLOSED = 4;
+
+	namespace Private
+	{
+		//Bounded multi-producer multi-consumer ring buffer. Each cell's sequence number says which lap it is ready to be written or read on,
+		//so producers and consumers only contend on their own end's index.
+		template<typename T>
+		class TBoundedRing
+		{
+			struct FCell
+			{
+				std::atomic<uint64> Sequence;
+				TOptional<T> Value;
+			};
+
+		public:
+			TBoundedRing(const uint32 InCapacity)
+				: Capacity(InCapacity)
+				, Cells(MakeUnique<FCell[]>(InCapacity))
+			{
+				for (uint32 i = 0; i < Capacity; ++i)
+				{
+					Cells[i].Sequence.store(i, std::memory_order_relaxed);
+				}
+			}
+
+			//Only moves from the item when it was pushed
+			bool TryPush(T&& Item)
+			{
+				uint64 Position = Tail.load(std::memory_order_relaxed);
+				for (;;)
+				{
+					FCell& Cell = Cells[Position % Capacity];
+					const int64 Lap = (int64)Cell.Sequence.load(std::memory_order_acquire) - (int64)Position;
+					if (Lap == 0)
+					{
+						if (Tail.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+						{
+							Cell.Value.Emplace(MoveTemp(Item));
+							Cell.Sequence.store(Position + 1, std::memory_order_release);
+							return true;
+						}
+					}
+					else if (Lap < 0)
+					{
+						return false; //full
+					}
+					else
+					{
+						Position = Tail.load(std::memory_order_relaxed);
+					}
+				}
+			}
+
+			bool TryPop(TOptional<T>& OutItem)
+			{
+				uint64 Position = Head.load(std::memory_order_relaxed);
+				for (;;)
+				{
+					FCell& Cell = Cells[Position % Capacity];
+					const int64 Lap = (int64)Cell.Sequence.load(std::memory_order_acquire) - (int64)(Position + 1);
+					if (Lap == 0)
+					{
+						if (Head.compare_exchange_weak(Position, Position + 1, std::memory_order_relaxed))
+						{
+							OutItem.Emplace(MoveTemp(Cell.Value.GetValue()));
+							Cell.Value.Reset();
+							Cell.Sequence.store(Position + Capacity, std::memory_order_release);
+							return true;
+						}
+					}
+					else if (Lap < 0)
+					{
+						return false; //empty
+					}
+					else
+					{
+						Position = Head.load(std::memory_order_relaxed);
+					}
+				}
+			}
+
+			bool IsEmpty() const
+			{
+				return Head.load(std::memory_order_acquire) >= Tail.load(std::memory_order_acquire);
+			}
+
+		private:
+			const uint32 Capacity;
+			TUniquePtr<FCell[]> Cells;
+			alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> Head = 0;
+			alignas(PLATFORM_CACHE_LINE_SIZE) std::atomic<uint64> Tail = 0;
+		};
+
+		//Items go through the lock-free ring whenever possible. The lock only guards the queues of senders waiting for space and
+		//receivers waiting for items, and is only taken when one side has to wait or the other side has someone waiting.
+		template<typename T>
+		class TChannelState
+		{
+			struct FPendingSend
+			{
+				T Item;
+				TAsyncPromise<void> Promise;
+			};
+
+		public:
+			TChannelState(const int32 Capacity) : Ring(Capacity) {}
+
+			TAsyncFuture<void> Send(T&& Item)
+			{
+				//Counted before checking Closed, so either Close waits for this push or this send sees the channel closed
+				++NumSending;
+				if (Closed)
+				{
+					--NumSending;
+					return MakeErrorFuture<void>(MakeClosedError());
+				}
+
+				//Only take the fast path when nobody is queued ahead of us, so a producer's items stay in order
+				const bool bPushed = NumWaitingSenders.load() == 0 && Ring.TryPush(MoveTemp(Item));
+				--NumSending;
+				if (bPushed)
+				{
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+					if (NumWaitingReceivers.load() > 0)
+					{
+						Pump();
+					}
+					return MakeReadyFuture();
+				}
+
+				TAsyncPromise<void> Promise;
+				{
+					FScopeLock Lock(&CriticalSection);
+					if (Closed)
+					{
+						Promise.SetValue(MakeClosedError());
+						return Promise.GetFuture();
+					}
+
+					++NumWaitingSenders;
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+					if (SendWaiters.IsEmpty() && Ring.TryPush(MoveTemp(Item)))
+					{
+						--NumWaitingSenders;
+						Promise.SetValue();
+					}
+					else
+					{
+						SendWaiters.Enqueue(TOptional<FPendingSend>(FPendingSend{ MoveTemp(Item), Promise }));
+					}
+				}
+
+				if (Promise.IsSet())
+				{
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+					if (NumWaitingReceivers.load() > 0)
+					{
+						Pump();
+					}
+				}
+				return Promise.GetFuture();
+			}
+
+			TAsyncFuture<T> Receive()
+			{
+				TOptional<T> Item;
+				if (NumWaitingReceivers.load() == 0 && Ring.TryPop(Item))
+				{
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+					if (NumWaitingSenders.load() > 0)
+					{
+						Pump();
+					}
+					return MakeReadyFuture<T>(MoveTemp(Item.GetValue()));
+				}
+
+				TAsyncPromise<T> Promise;
+				{
+					FScopeLock Lock(&CriticalSection);
+					++NumWaitingReceivers;
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+					if (ReceiveWaiters.IsEmpty() && Ring.TryPop(Item))
+					{
+						--NumWaitingReceivers;
+					}
+					else if (Closed && Ring.IsEmpty())
+					{
+						//Closed and drained
+						--NumWaitingReceivers;
+						Promise.SetValue(MakeClosedError());
+						return Promise.GetFuture();
+					}
+					else
+					{
+						ReceiveWaiters.Enqueue(TOptional<TAsyncPromise<T>>(Promise));
+						return Promise.GetFuture();
+					}
+				}
+
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if (NumWaitingSenders.load() > 0)
+				{
+					Pump();
+				}
+				Promise.SetValue(MoveTemp(Item.GetValue()));
+				return Promise.GetFuture();
+			}
+
+			void Close()
+			{
+				Closed = true;
+				//Sends that saw the channel open finish pushing first, so their items are drained rather than lost
+				while (NumSending.load() > 0)
+				{
+					FPlatformProcess::Yield();
+				}
+				Pump();
+			}
+
+			bool IsClosed() const { return Closed; }
+
+		private:
+			//Moves waiting senders' items into the ring and ring items out to waiting receivers until neither can make progress
+			void Pump()
+			{
+				TArray<TAsyncPromise<void>> CompletedSends;
+				TArray<TPair<TAsyncPromise<T>, T>> CompletedReceives;
+				TArray<TAsyncPromise<void>> FailedSends;
+				TArray<TAsyncPromise<T>> FailedReceives;
+				{
+					FScopeLock Lock(&CriticalSection);
+					bool bProgress = true;
+					while (bProgress)
+					{
+						bProgress = false;
+						while (TOptional<FPendingSend>* Pending = SendWaiters.Peek())
+						{
+							if (!Ring.TryPush(MoveTemp(Pending->GetValue().Item)))
+							{
+								break;
+							}
+							CompletedSends.Add(Pending->GetValue().Promise);
+							SendWaiters.Pop();
+							--NumWaitingSenders;
+							bProgress = true;
+						}
+
+						while (ReceiveWaiters.Peek() != nullptr)
+						{
+							TOptional<T> Item;
+							if (!Ring.TryPop(Item))
+							{
+								break;
+							}
+							TOptional<TAsyncPromise<T>> Receiver;
+							ReceiveWaiters.Dequeue(Receiver);
+							CompletedReceives.Emplace(MoveTemp(Receiver.GetValue()), MoveTemp(Item.GetValue()));
+							--NumWaitingReceivers;
+							bProgress = true;
+						}
+					}
+
+					if (Closed)
+					{
+						TOptional<FPendingSend> Pending;
+						while (SendWaiters.Dequeue(Pending))
+						{
+							FailedSends.Add(Pending->Promise);
+							--NumWaitingSenders;
+						}
+
+						TOptional<TAsyncPromise<T>> Receiver;
+						while (Ring.IsEmpty() && ReceiveWaiters.Dequeue(Receiver))
+						{
+							FailedReceives.Add(MoveTemp(Receiver.GetValue()));
+							--NumWaitingReceivers;
+						}
+					}
+				}
+
+				//Fulfil outside the lock as this schedules the continuations
+				for (const TAsyncPromise<void>& Promise : CompletedSends)
+				{
+					Promise.SetValue();
+				}
+				for (TPair<TAsyncPromise<T>, T>& Receive : CompletedReceives)
+				{
+					Receive.Key.SetValue(MoveTemp(Receive.Value));
+				}
+				for (const TAsyncPromise<void>& Promise : FailedSends)
+				{
+					Promise.SetValue(MakeClosedError());
+				}
+				for (const TAsyncPromise<T>& Promise : FailedReceives)
+				{
+					Promise.SetValue(MakeClosedError());
+				}
+			}
+
+			static FError MakeClosedError()
+			{
+				return FError(ERROR_CONTEXT_FUTURE, ERROR_CHANNEL_CLOSED, TEXT("Channel is closed"));
+			}
+
+			TBoundedRing<T> Ring;
+
+			FCriticalSection CriticalSection;
+			TQueue<TOptional<FPendingSend>> SendWaiters;
+			TQueue<TOptional<TAsyncPromise<T>>> ReceiveWaiters;
+			std::atomic<int32> NumWaitingSenders = 0;
+			std::atomic<int32> NumWaitingReceivers = 0;
+			std::atomic<int32> NumSending = 0;
+			std::atomic_bool Closed = false;
+		};
+	}
+
+	//Copyable handle to a fixed capacity channel. Send completes once the item fits in the channel and Receive completes once an item arrives,
+	//so producers are held back instead of queueing without bound. Once closed, sends fail and receives fail after the remaining items are drained.
+	template<typename T>
+	class TAsyncChannel
+	{
+	public:
+		TAsyncChannel(const int32 Capacity)
+			: State(MakeShared<Private::TChannelState<T>, ESPMode::ThreadSafe>(Capacity))
+		{
+			check(Capacity > 0);
+		}
+
+		TAsyncChannel(const TAsyncChannel& Other) = default;
+		TAsyncChannel& operator=(const TAsyncChannel& Other) = default;
+		TAsyncChannel(TAsyncChannel&& Other) = default;
+		TAsyncChannel& operator=(TAsyncChannel&& Other) = default;
+
+		TAsyncFuture<void> Send(const T& Item) const { return State->Send(T(Item)); }
+		TAsyncFuture<void> Send(T&& Item) const { return State->Send(MoveTemp(Item)); }
+		TAsyncFuture<T> Receive() const { return State->Receive(); }
+
+		void Close() const { State->Close(); }
+		bool IsClosed() const { return State->IsClosed(); }
+
+	private:
+		TSharedRef<Private::TChannelState<T>, ESPMode::ThreadSafe> State;
+	};
+}
@@ -11,14 +11,16 @@
 #include "Misc/QueuedThreadPool.h"
 
 // Module Includes
+#include "CallSite.h"
 #include "Error.h"
 #include "LifetimeMonitor.h"
 #include "Result.h"
 #include "PromiseState.h"
+#include "Scheduler.h"
 
 namespace UE::Tasks
 {
-	uint64 ERROR_LIFETIME = 2;
+	inline uint64 ERROR_LIFETIME = 2;
 	class FOptions;
 
 	namespace Private
@@ -29,6 +31,8 @@ namespace UE::Tasks
 			const TSharedRef<TPromiseState<ResultType>, ESPMode::ThreadSafe>& PreviousPromise,
 			const FOptions& Options,
 			Monitor LifetimeMonitor);
+
+		struct FFutureAccess;
 	}
 
 	template<typename ResultType>
@@ -72,22 +76,26 @@ namespace UE::Tasks
 		bool IsReady() const { return IsValid() && Promise->IsSet(); }
 		ExpectedResultType Get() const { check(IsReady()); return Promise->Get(); }
 
+		//Starts lazy work, attaching a continuation also starts it
+		void Start() const { check(IsValid()); Promise->Start(); }
+
 		//Continuations
 		template<typename Func>
-		auto Then(Func&& Function, const FOptions& Options = FOptions()) const
+		auto Then(Func&& Function, const FOptions& Options = FOptions(), const FCallSite& CallSite = FCallSite()) const
 		{
 			check(IsValid())
-			return Private::Then<Func, ResultType>(Forward<Func>(Function), Promise.ToSharedRef(), Options, TLifetimeMonitor<void>());
+			return Private::Then<Func, ResultType>(Forward<Func>(Function), Promise.ToSharedRef(), Options.WithCallSite(CallSite), TLifetimeMonitor<void>());
 		}
 
 		template<typename Func, typename TOwner>
-		auto Then(TOwner* Owner, Func&& Function, const FOptions& Options = FOptions()) const
+		auto Then(TOwner* Owner, Func&& Function, const FOptions& Options = FOptions(), const FCallSite& CallSite = FCallSite()) const
 		{
 			check(IsValid())
-			return Private::Then<Func, ResultType>(Forward<Func>(Function), Promise.ToSharedRef(), Options, TLifetimeMonitor<TOwner>(Owner));
+			return Private::Then<Func, ResultType>(Forward<Func>(Function), Promise.ToSharedRef(), Options.WithCallSite(CallSite), TLifetimeMonitor<TOwner>(Owner));
 		}
 
 	private:
+		friend struct Private::FFutureAccess;
 		TSharedPtr<Private::TPromiseState<ResultType>, ESPMode::ThreadSafe> Promise;
 	};
 
@@ -133,22 +141,26 @@ namespace UE::Tasks
 		bool IsReady() const { return IsValid() && Promise->IsSet(); }
 		ExpectedResultType Get() const { check(IsReady()); return Promise->Get(); }
 
+		//Starts lazy work, attaching a continuation also starts it
+		void Start() const { check(IsValid()); Promise->Start(); }
+
 		//Continuations
 		template<typename Func>
-		auto Then(Func&& Function, const FOptions& Options = FOptions()) const
+		auto Then(Func&& Function, const FOptions& Options = FOptions(), const FCallSite& CallSite = FCallSite()) const
 		{
 			check(IsValid());
-			return Private::Then(MoveTemp(Function), Promise.ToSharedRef(), Options, TLifetimeMonitor<void>());
+			return Private::Then(MoveTemp(Function), Promise.ToSharedRef(), Options.WithCallSite(CallSite), TLifetimeMonitor<void>());
 		}
 
 		template<typename Func, typename TOwner>
-		auto Then(TOwner* Owner, Func&& Function, const FOptions& Options = FOptions()) const
+		auto Then(TOwner* Owner, Func&& Function, const FOptions& Options = FOptions(), const FCallSite& CallSite = FCallSite()) const
 		{
 			check(IsValid());
-			return Private::Then(MoveTemp(Function), Promise.ToSharedRef(), Options, TLifetimeMonitor<TOwner>(Owner));
+			return Private::Then(MoveTemp(Function), Promise.ToSharedRef(), Options.WithCallSite(CallSite), TLifetimeMonitor<TOwner>(Owner));
 		}
 
 	private:
+		friend struct Private::FFutureAccess;
 		TSharedPtr<Private::TPromiseState<void>, ESPMode::ThreadSafe> Promise;
 	};
 
@@ -156,14 +168,32 @@ namespace UE::Tasks
 	class TAsyncPromise
 	{
 	public:
-		TAsyncPromise()
+		explicit TAsyncPromise(const FCallSite& CallSite = FCallSite())
 			: State(MakeShared<Private::TPromiseState<T>>())
-		{}
+		{
+			State->Track(CallSite);
+			State->AddPromise();
+		}
+		explicit TAsyncPromise(const TSharedRef<Private::TPromiseState<T>, ESPMode::ThreadSafe>& InState)
+			: State(InState)
+		{
+			State->AddPromise();
+		}
+		~TAsyncPromise() { State->ReleasePromise(); }
 
-		TAsyncPromise(const TAsyncPromise& Other) = default;
-		TAsyncPromise& operator=(const TAsyncPromise& Other) = default;
-		TAsyncPromise(TAsyncPromise&& Other) = default;
-		TAsyncPromise& operator=(TAsyncPromise&& Other) = default;
+		//No moves, a TSharedRef can't be emptied so the moved from promise would still be counted
+		TAsyncPromise(const TAsyncPromise& Other)
+			: State(Other.State)
+		{
+			State->AddPromise();
+		}
+		TAsyncPromise& operator=(const TAsyncPromise& Other)
+		{
+			Other.State->AddPromise();
+			State->ReleasePromise();
+			State = Other.State;
+			return *this;
+		}
 
 		TAsyncFuture<T> GetFuture() { return TAsyncFuture<T>(State); }
 		bool IsSet() const { return State->IsSet(); }
@@ -187,14 +217,32 @@ namespace UE::Tasks
 	class TAsyncPromise<void>
 	{
 	public:
-		TAsyncPromise()
+		explicit TAsyncPromise(const FCallSite& CallSite = FCallSite())
 			: State(MakeShared<Private::TPromiseState<void>>())
-		{}
+		{
+			State->Track(CallSite);
+			State->AddPromise();
+		}
+		explicit TAsyncPromise(const TSharedRef<Private::TPromiseState<void>, ESPMode::ThreadSafe>& InState)
+			: State(InState)
+		{
+			State->AddPromise();
+		}
+		~TAsyncPromise() { State->ReleasePromise(); }
 
-		TAsyncPromise(const TAsyncPromise& Other) = default;
-		TAsyncPromise& operator=(const TAsyncPromise& Other) = default;
-		TAsyncPromise(TAsyncPromise&& Other) = default;
-		TAsyncPromise& operator=(TAsyncPromise&& Other) = default;
+		//No moves, a TSharedRef can't be emptied so the moved from promise would still be counted
+		TAsyncPromise(const TAsyncPromise& Other)
+			: State(Other.State)
+		{
+			State->AddPromise();
+		}
+		TAsyncPromise& operator=(const TAsyncPromise& Other)
+		{
+			Other.State->AddPromise();
+			State->ReleasePromise();
+			State = Other.State;
+			return *this;
+		}
 
 		TAsyncFuture<void> GetFuture() { return TAsyncFuture<void>(State); }
 		bool IsSet() const { return State->IsSet(); }
@@ -214,6 +262,17 @@ namespace UE::Tasks
 
 	namespace Private
 	{
+		//Gives the module's own awaiters and combinators access to the state behind a future
+		struct FFutureAccess
+		{
+			template<typename T>
+			static TSharedRef<TPromiseState<T>, ESPMode::ThreadSafe> GetState(const TAsyncFuture<T>& Future)
+			{
+				check(Future.IsValid());
+				return Future.Promise.ToSharedRef();
+			}
+		};
+
 		class IBoundPromise
 		{
 		public:
@@ -221,15 +280,16 @@ namespace UE::Tasks
 			virtual ~IBoundPromise() {}
 		};
 
+		//Holds the state rather than a TAsyncPromise, so only being able to cancel it doesn't stop the promise being reported as broken
 		template<typename TPromiseType>
 		class TBoundPromise : public IBoundPromise
 		{
 		public:
-			TBoundPromise(const TAsyncPromise<TPromiseType>& PromiseIn) : Promise(PromiseIn) {  }
-			TBoundPromise(TAsyncPromise<TPromiseType>&& PromiseIn) : Promise(MoveTemp(PromiseIn)) {  }
-			virtual void Cancel() const override { Promise.Cancel(); }
+			TBoundPromise(const TAsyncPromise<TPromiseType>& PromiseIn) : State(PromiseIn.State) {  }
+			TBoundPromise(const TSharedRef<TPromiseState<TPromiseType>, ESPMode::ThreadSafe>& StateIn) : State(StateIn) {  }
+			virtual void Cancel() const override { State->SetValue(TResult<TPromiseType>(MakeCancelledError())); }
 		private:
-			TAsyncPromise<TPromiseType> Promise;
+			TSharedRef<TPromiseState<TPromiseType>, ESPMode::ThreadSafe> State;
 		};
 
 		class FCancellationState
@@ -239,28 +299,39 @@ namespace UE::Tasks
 			~FCancellationState() { Cancel(); }
 			void Cancel()
 			{
-				Cancelled = true;
-				for (const TSharedRef<IBoundPromise, ESPMode::ThreadSafe>& Promise : Promises)
+				//Cancelled outside the lock, cancelling runs continuations that may bind to this handle again
+				TArray<TSharedRef<IBoundPromise, ESPMode::ThreadSafe>> Cancelling;
+				{
+					FScopeLock Lock(&CriticalSection);
+					Cancelled = true;
+					Cancelling = MoveTemp(Promises);
+				}
+				for (const TSharedRef<IBoundPromise, ESPMode::ThreadSafe>& Promise : Cancelling)
 				{
 					Promise->Cancel();
 				}
-				Promises.Empty();
 			}
 
 			template<typename TPromiseType>
 			void Bind(const TAsyncPromise<TPromiseType>& PromiseIn)
 			{
-				if (Cancelled)
 				{
-					PromiseIn.Cancel();
-					return;
+					FScopeLock Lock(&CriticalSection);
+					if (!Cancelled)
+					{
+						TSharedRef<TBoundPromise<TPromiseType>, ESPMode::ThreadSafe> BoundPromise = MakeShared<TBoundPromise<TPromiseType>>(PromiseIn);
+						Promises.Emplace(MoveTemp(BoundPromise));
+						return;
+					}
 				}
-				TSharedRef<TBoundPromise<TPromiseType>, ESPMode::ThreadSafe> BoundPromise = MakeShared<TBoundPromise<TPromiseType>>(PromiseIn);
-				Promises.Emplace(MoveTemp(BoundPromise));
+				PromiseIn.Cancel();
 			}
 
+			bool IsCancelled() const { return Cancelled; }
+
 		private:
 			std::atomic_bool Cancelled = false;
+			FCriticalSection CriticalSection;
 			TArray<TSharedRef<IBoundPromise, ESPMode::ThreadSafe>> Promises;
 		};
 	}
@@ -278,6 +349,7 @@ namespace UE::Tasks
 		template<typename TPromiseType>
 		void Bind(const TAsyncPromise<TPromiseType>& PromiseIn) { State->Bind(PromiseIn); }
 		void Cancel() { State->Cancel(); }
+		bool IsCancelled() const { return State->IsCancelled(); }
 	private:
 		TSharedRef<Private::FCancellationState, ESPMode::ThreadSafe> State;
 		friend class FWeakCancellationHandle;
@@ -299,10 +371,25 @@ namespace UE::Tasks
 		FWeakCancellationHandle& operator= (const FWeakCancellationHandle& Other) { State = Other.State; return *this; }
 		FWeakCancellationHandle& operator= (FWeakCancellationHandle&& Other) { State = MoveTemp(Other.State); return *this; }
 
+		//False once every FCancellationHandle sharing the state has gone
+		bool IsValid() const { return State.IsValid(); }
+		bool IsCancelled() const
+		{
+			const TSharedPtr<Private::FCancellationState, ESPMode::ThreadSafe> Pinned = State.Pin();
+			return Pinned.IsValid() && Pinned->IsCancelled();
+		}
+
 	private:
 		TWeakPtr<Private::FCancellationState, ESPMode::ThreadSafe> State;
 	};
 
+	//Lazy work only starts once a continuation is attached, it's awaited or Start is called. If it's never observed it never runs
+	enum class EStartPolicy : uint8
+	{
+		Eager,
+		Lazy
+	};
+
 	class FOptions
 	{
 	public:
@@ -310,25 +397,73 @@ namespace UE::Tasks
 			: Thread(TOptional<ENamedThreads::Type>())
 			, CancellationHandle(TOptional<FCancellationHandle>())
 			, Execution(TOptional<EAsyncExecution>())
+			, Priority(TOptional<EAsyncPriority>())
+			, StartPolicy(TOptional<EStartPolicy>())
+			, Name(nullptr)
+			, StatId()
 		{
 		}
 
 		FOptions& Set(const ENamedThreads::Type ThreadIn) { Thread = ThreadIn; return *this; }
 		FOptions& Set(const FCancellationHandle& HandleIn) { CancellationHandle = HandleIn; return *this; }
 		FOptions& Set(const EAsyncExecution ExecutionIn) { Execution = ExecutionIn; return *this; }
+		FOptions& Set(const EAsyncPriority PriorityIn) { Priority = PriorityIn; return *this; }
+		FOptions& Set(const EStartPolicy StartPolicyIn) { StartPolicy = StartPolicyIn; return *this; }
+		//Names the work in Insights. Not copied, so it needs to outlive the work - a literal is expected
+		FOptions& Set(const TCHAR* NameIn) { Name = NameIn; return *this; }
+		FOptions& Set(const TStatId StatIdIn) { StatId = StatIdIn; return *this; }
+		FOptions& Set(const FCallSite& CallSiteIn) { CallSite = CallSiteIn; return *this; }
+		//Keeps a call site that's already set, so wrappers can pass on the location they were called from
+		FOptions WithCallSite(const FCallSite& CallSiteIn) const { FOptions Options(*this); if (!CallSite.IsSet()) { Options.CallSite = CallSiteIn; } return Options; }
 		
 		TOptional<FCancellationHandle> GetCancellation() const { return CancellationHandle; }
 		ENamedThreads::Type GetDesiredThread() const {	return Thread.Get(ENamedThreads::AnyThread); }
 		EAsyncExecution GetExecutionPolicy() const {	return Execution.Get(EAsyncExecution::TaskGraph); }
+		//Unset keeps whatever priority the thread encodes and bypasses the priority queues
+		TOptional<EAsyncPriority> GetPriority() const { return Priority; }
+		EStartPolicy GetStartPolicy() const { return StartPolicy.Get(EStartPolicy::Eager); }
+		const TCHAR* GetName() const { return Name; }
+		TStatId GetStatId() const { return StatId; }
+		const TOptional<FCallSite>& GetCallSite() const { return CallSite; }
 
 	private:
 		TOptional<ENamedThreads::Type> Thread;
 		TOptional<FCancellationHandle> CancellationHandle;
 		TOptional<EAsyncExecution> Execution;
+		TOptional<EAsyncPriority> Priority;
+		TOptional<EStartPolicy> StartPolicy;
+		const TCHAR* Name;
+		TStatId StatId;
+		TOptional<FCallSite> CallSite;
 	};
 
 	namespace Private
 	{
+		//Fulfils the promise with the future a continuation returned
+		template<typename P>
+		void ForwardFuture(const TAsyncPromise<P>& Promise, const TAsyncFuture<P>& Future)
+		{
+			const uint64 TrackingId = Promise.State->GetTrackingId();
+			if (TrackingId != 0 && Future.IsValid())
+			{
+				RelinkTrackedPromise(TrackingId, FFutureAccess::GetState(Future)->GetTrackingId());
+			}
+
+			const uint64 CaptureId = Promise.State->CaptureId.load();
+			if (CaptureId != 0 && Future.IsValid())
+			{
+				const auto FutureState = FFutureAccess::GetState(Future);
+				FutureState->CaptureId = CaptureForwarded(FutureState->CaptureId.load(), CaptureId, FutureState->IsSet());
+			}
+
+			TAsyncFuture<void> Forwarding = Future.Then([Promise](const TResult<P>& Value) { Promise.SetValue(Value); });
+			if (CaptureId != 0)
+			{
+				//The forwarding continuation is plumbing, the graph already has the edge it stands for
+				DiscardCapturedNode(FFutureAccess::GetState(Forwarding)->CaptureId.load());
+			}
+		}
+
 		template<typename P, typename R, typename F,
 			typename TContinuationTypes<F, R>::Traits::IsVoidToVoid::Type* = nullptr>
 		void ExecuteContinuation(const TAsyncPromise<P>& Promise, const TResult<R>& Result, F&& Function)
@@ -494,7 +629,7 @@ namespace UE::Tasks
 			}
 			else
 			{
-				Function().Then([Promise](const TResult<P>& Value) { Promise.SetValue(Value); });
+				ForwardFuture(Promise, Function());
 			}
 		}
 
@@ -513,7 +648,7 @@ namespace UE::Tasks
 			}
 			else if (Result.HasValue())
 			{
-				Function(Result.GetValue()).Then([Promise](const TResult<P>& Value) { Promise.SetValue(Value); });
+				ForwardFuture(Promise, Function(Result.GetValue()));
 			}
 			else
 			{
@@ -525,188 +660,82 @@ namespace UE::Tasks
 			typename TContinuationTypes<F, R>::Traits::IsResultToFuture::Type* = nullptr>
 		void ExecuteContinuation(const TAsyncPromise<P>& Promise, const TResult<R>& Result, F&& Function)
 		{
-			Function(Result).Then([Promise](const TResult<P>& Value) { Promise.SetValue(Value); });
+			ForwardFuture(Promise, Function(Result));
 		}
 	}
 
 	namespace Private
 	{
-		//Wrapper task for the async call. When this executes we then schedule a free task on whatever thread/execution we've specified
-		template<typename TFunctionType, typename TResultType, typename TPromiseType, typename TLifetimeMonitor>
-		class TContinuationTask : public FAsyncGraphTaskBase
+		template<typename TFutureType, typename ResultType, typename TRootFunction, typename Monitor>
+		void LaunchContinuation(
+			const TAsyncPromise<TFutureType>& Promise,
+			const TSharedRef<TPromiseState<ResultType>, ESPMode::ThreadSafe>& PreviousPromise,
+			TRootFunction&& Function,
+			Monitor&& LifetimeMonitor,
+			const FOptions& Options)
 		{
-			using TPromiseRef = TSharedRef<TAsyncPromise<TPromiseType>, ESPMode::ThreadSafe>;
-			using TRootFunction = typename std::remove_cv_t<typename TRemoveReference<TFunctionType>::Type>;
+			//Waiting on a lazy promise is what starts it
+			PreviousPromise->Start();
+			TraceContinuationScheduled(PreviousPromise->TraceId, Promise.State->TraceId, Options.GetName());
+			const int32 CallSiteWeight = Options.GetCallSite().IsSet() ? SampleCallSite() : 0;
 
-		public:
-			TContinuationTask(TFunctionType&& InFunction, 
-				TPromiseRef&& InPromise,
-				const TSharedRef<TPromiseState<TResultType>, ESPMode::ThreadSafe>& InPreviousPromise,
-				TLifetimeMonitor&& InLifetimeMonitor,
-				const FOptions& Options)
-				: MyPromise(MoveTemp(InPromise))
-				, PreviousPromise(InPreviousPromise)
-				, ContinuationFunction(Forward<TFunctionType>(InFunction))
-				, LifetimeMonitor(MoveTemp(InLifetimeMonitor))
-				, DesiredThread(Options.GetDesiredThread())
-				, Execution(Options.GetExecutionPolicy())
-			{
-				const TOptional<FCancellationHandle>& Cancellation = Options.GetCancellation();
-				if (Cancellation.IsSet())
+			auto Continuation = [
+				Promise,
+				PreviousPromise,
+				ContinuationFunction = MoveTemp(Function),
+				LifetimeMonitor = MoveTemp(LifetimeMonitor),
+				Options,
+				CallSiteWeight
+			](const uint64 ReadyCycles) mutable
 				{
-					FCancellationHandle Handle = Cancellation.GetValue();
-					Handle.Bind(*MyPromise);
-				}
-			}
-
-			void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
-			{
-				check(PreviousPromise->IsSet());
-				auto Function = [
-					InPromise = MoveTemp(MyPromise),
-					InPreviousPromise = MoveTemp(PreviousPromise), 
-					InContinuationFunction = MoveTemp(ContinuationFunction),
-					InLifetimeMonitor = MoveTemp(LifetimeMonitor),
-					InThread = MoveTemp(DesiredThread)
-				]() mutable -> int32
+					FExecutionScope Scope(Options, &Promise.State.Get());
+					FTraceContinuationScope TraceScope(Promise.State->TraceId, Options.GetName(), Options.GetStatId());
+					FGraphCaptureScope CaptureScope(Promise.State->CaptureId.load());
+					FCallSiteScope CallSiteScope(Options.GetCallSite().GetPtrOrNull(), CallSiteWeight, ReadyCycles);
+					if (!Promise.IsSet())
 					{
-						if (!InPromise->IsSet())
+						if (auto PinnedObject = LifetimeMonitor.Pin())
 						{
-							if (auto PinnedObject = InLifetimeMonitor.Pin())
-							{
-								check(InPreviousPromise->IsSet());
-								ExecuteContinuation(*InPromise, InPreviousPromise->Get(), MoveTemp(InContinuationFunction));
-							}
-							else
-							{
-								InPromise->SetValue(FError(ERROR_CONTEXT_FUTURE, ERROR_LIFETIME, TEXT("Owner lifetime expired")));
-							}
+							check(PreviousPromise->IsSet());
+							ExecuteContinuation(Promise, PreviousPromise->Get(), MoveTemp(ContinuationFunction));
+						}
+						else
+						{
+							RecordLifetimeExpired();
+							Promise.SetValue(FError(ERROR_CONTEXT_FUTURE, ERROR_LIFETIME, TEXT("Owner lifetime expired")));
 						}
-
-						return 0;
-					};
-				TPromise<int32> Promise = TPromise<int32>();
-				//Copied from Async.h to allow us to pass the thread to the task graph
-				switch (Execution)
-				{
-				case EAsyncExecution::TaskGraphMainThread:
-				{
-					TGraphTask<TAsyncGraphTask<int32>>::CreateTask().
-						ConstructAndDispatchWhenReady(
-							MoveTemp(Function), 
-							MoveTemp(Promise),
-							ENamedThreads::GameThread);
-				}
-				break;
-				case EAsyncExecution::TaskGraph:
-				{
-					TGraphTask<TAsyncGraphTask<int32>>::CreateTask().
-						ConstructAndDispatchWhenReady(
-							MoveTemp(Function), 
-							MoveTemp(Promise),
-							DesiredThread);
-				}
-				break;
-
-				case EAsyncExecution::Thread:
-					if (FPlatformProcess::SupportsMultithreading())
-					{
-						TPromise<FRunnableThread*> ThreadPromise = TPromise<FRunnableThread*>();
-						TAsyncRunnable<int32>* Runnable = new TAsyncRunnable<int32>(
-							MoveTemp(Function), 
-							MoveTemp(Promise),
-							ThreadPromise.GetFuture());
-
-						const FString TAsyncThreadName = FString::Printf(TEXT("TAsync %d"), FAsyncThreadIndex::GetNext());
-						FRunnableThread* RunnableThread = FRunnableThread::Create(Runnable, *TAsyncThreadName);
-
-						check(RunnableThread != nullptr);
-						check(RunnableThread->GetThreadType() == FRunnableThread::ThreadType::Real);
-
-						ThreadPromise.SetValue(RunnableThread);
-					}
-					else
-					{
-						Function();
-					}
-					break;
-
-				case EAsyncExecution::ThreadIfForkSafe:
-					if (FPlatformProcess::SupportsMultithreading() || FForkProcessHelper::IsForkedMultithreadInstance())
-					{
-						TPromise<FRunnableThread*> ThreadPromise;
-						TAsyncRunnable<int32>* Runnable = new TAsyncRunnable<int32>(
-							MoveTemp(Function), 
-							MoveTemp(Promise),
-							ThreadPromise.GetFuture());
-
-						const FString TAsyncThreadName = FString::Printf(TEXT("TAsync %d"), FAsyncThreadIndex::GetNext());
-						FRunnableThread* RunnableThread = FForkProcessHelper::CreateForkableThread(Runnable, *TAsyncThreadName);
-
-						check(RunnableThread != nullptr);
-						check(RunnableThread->GetThreadType() == FRunnableThread::ThreadType::Real);
-
-						ThreadPromise.SetValue(RunnableThread);
-					}
-					else
-					{
-						Function();
 					}
-					break;
+				};
 
-				case EAsyncExecution::ThreadPool:
-					if (FPlatformProcess::SupportsMultithreading())
-					{
-						check(GThreadPool != nullptr);
-						GThreadPool->AddQueuedWork(new TAsyncQueuedWork<int32>(MoveTemp(Function), MoveTemp(Promise)));
-					}
-					else
-					{
-						Function();
-					}
-					break;
+			if (PreviousPromise->IsSet())
+			{
+				Dispatch(Options, [Continuation = MoveTemp(Continuation), ReadyCycles = CallSiteWeight > 0 ? FPlatformTime::Cycles64() : 0]() mutable { Continuation(ReadyCycles); });
+				return;
+			}
 
-#if WITH_EDITOR
-				case EAsyncExecution::LargeThreadPool:
-					if (FPlatformProcess::SupportsMultithreading())
+			//Runs on whichever thread fulfils the previous promise. When that's the previous stage itself finishing, on the executor this stage wants,
+			//and nothing else is waiting on it, the two stages fuse and this one runs straight away instead of being scheduled again.
+			//Promises fulfilled from inside some other stage, by hand, a semaphore or a channel, still get their continuations scheduled.
+			typename TPromiseState<ResultType>::FCallback OnReady = [Continuation = MoveTemp(Continuation), PreviousPromise, Options, CallSiteWeight](const TResult<ResultType>&) mutable
+				{
+					const uint64 ReadyCycles = CallSiteWeight > 0 ? FPlatformTime::Cycles64() : 0;
+					if (PreviousPromise->GetNumCallbacks() == 1 && CanRunInline(Options, &PreviousPromise.Get()))
 					{
-						check(GLargeThreadPool != nullptr);
-						GLargeThreadPool->AddQueuedWork(new TAsyncQueuedWork<int32>(MoveTemp(Function), MoveTemp(Promise)));
+						RecordFused();
+						Continuation(ReadyCycles);
 					}
 					else
 					{
-						Function();
+						Dispatch(Options, [Continuation = MoveTemp(Continuation), ReadyCycles]() mutable { Continuation(ReadyCycles); });
 					}
-					break;
-#endif
-
-				default:
-					check(false); // not implemented!
-				}
-			}
+				};
 
-			ENamedThreads::Type GetDesiredThread()
+			if (!PreviousPromise->AddCallback(MoveTemp(OnReady)))
 			{
-				//This just schedules the unlock
-				return ENamedThreads::AnyThread;
+				OnReady(PreviousPromise->Get());
 			}
+		}
 
-		private:
-
-			TPromiseRef MyPromise;
-			TSharedRef<TPromiseState<TResultType>, ESPMode::ThreadSafe> PreviousPromise;
-
-			TRootFunction ContinuationFunction;
-
-			TLifetimeMonitor LifetimeMonitor;
-
-			ENamedThreads::Type DesiredThread;
-			EAsyncExecution Execution;
-		};
-	}
-
-	namespace Private
-	{
 		template<typename Func, typename ResultType, typename Monitor>
 		auto Then(
 			Func&& Function,
@@ -717,20 +746,49 @@ namespace UE::Tasks
 			using ContinuationFunctionTraits = TContinuationTypes<Func, ResultType>;
 			using TFutureType = TUnwrap_T<typename ContinuationFunctionTraits::ReturnType>;
 			using TParamResultType = TUnwrap_T<typename ContinuationFunctionTraits::ParamType>;
+			using TRootFunction = typename std::remove_cv_t<typename TRemoveReference<Func>::Type>;
 			static_assert(std::is_same<ResultType, TParamResultType>::value, "Parameter of the continuation needs to have the same type as the previous return.");
 			
 			//Create promise
-			TSharedRef<TAsyncPromise<TFutureType>> Promise = MakeShared<TAsyncPromise<TFutureType>>();
-			TAsyncFuture<TFutureType> Future = Promise->GetFuture();
-
-			//Make Scheduling task on the graphtask
-			FGraphEventArray Triggers{ PreviousPromise->GetCompletionEvent() };
-			TGraphTask<TContinuationTask<Func, ResultType, TFutureType, Monitor>>::CreateTask(&Triggers).ConstructAndDispatchWhenReady(
-				Forward<Func>(Function), 
-				MoveTemp(Promise), 
-				PreviousPromise,
-				MoveTemp(LifetimeMonitor),
-				Options);
+			TAsyncPromise<TFutureType> Promise(Options.GetCallSite().Get(FCallSite()));
+			TAsyncFuture<TFutureType> Future = Promise.GetFuture();
+			if (const uint64 TrackingId = Promise.State->GetTrackingId())
+			{
+				DescribeTrackedPromise(TrackingId, PreviousPromise->GetTrackingId(), Options);
+			}
+			if (PreviousPromise->CaptureId.load() != 0 || Promise.State->CaptureId.load() != 0)
+			{
+				Promise.State->CaptureId = CaptureContinuation(PreviousPromise->CaptureId.load(), Promise.State->CaptureId.load(), Options.GetName(), Options.GetCallSite().GetPtrOrNull());
+			}
+
+			const TOptional<FCancellationHandle>& Cancellation = Options.GetCancellation();
+			if (Cancellation.IsSet())
+			{
+				FCancellationHandle Handle = Cancellation.GetValue();
+				Handle.Bind(Promise);
+			}
+
+			if (Options.GetStartPolicy() == EStartPolicy::Lazy)
+			{
+				//Only a weak reference, so an unobserved lazy promise can be destroyed along with the work it never started
+				Promise.State->SetStarter([
+					WeakState = TWeakPtr<TPromiseState<TFutureType>, ESPMode::ThreadSafe>(Promise.State),
+					PreviousPromise,
+					ContinuationFunction = TRootFunction(Forward<Func>(Function)),
+					LifetimeMonitor = MoveTemp(LifetimeMonitor),
+					Options
+				]() mutable
+					{
+						if (const TSharedPtr<TPromiseState<TFutureType>, ESPMode::ThreadSafe> State = WeakState.Pin())
+						{
+							LaunchContinuation(TAsyncPromise<TFutureType>(State.ToSharedRef()), PreviousPromise, MoveTemp(ContinuationFunction), MoveTemp(LifetimeMonitor), Options);
+						}
+					});
+			}
+			else
+			{
+				LaunchContinuation(Promise, PreviousPromise, TRootFunction(Forward<Func>(Function)), MoveTemp(LifetimeMonitor), Options);
+			}
 
 			//return future
 			return Future;
@@ -3,13 +3,13 @@
 #include <atomic>
 
 #include "AsyncFuture.h"
+#include "GraphCapture.h"
 #include "Result.h"
-
-#include "Containers/Ticker.h"
+#include "Timer.h"
 
 namespace UE::Tasks
 {
-	uint64 ERROR_INVALID_ARGUMENT = 3;
+	inline uint64 ERROR_INVALID_ARGUMENT = 3;
 
 	enum class EFailMode
 	{
@@ -81,15 +81,15 @@ namespace UE::Tasks
 	}
 
 	template<typename F>
-	auto Async(F&& Function, const FOptions& FutureOptions = FOptions())
+	auto Async(F&& Function, const FOptions& FutureOptions = FOptions(), const FCallSite& CallSite = FCallSite())
 	{
-		return MakeReadyFuture().Then(MoveTemp(Function), FutureOptions);
+		return MakeReadyFuture().Then(MoveTemp(Function), FutureOptions, CallSite);
 	}
 
 	template<typename T, typename F>
-	auto Async(T* Owner, F&& Function, const FOptions& FutureOptions = FOptions())
+	auto Async(T* Owner, F&& Function, const FOptions& FutureOptions = FOptions(), const FCallSite& CallSite = FCallSite())
 	{
-		return MakeReadyFuture().Then(Owner, MoveTemp(Function), FutureOptions);
+		return MakeReadyFuture().Then(Owner, MoveTemp(Function), FutureOptions, CallSite);
 	}
 
 	template<typename T>
@@ -153,7 +153,7 @@ namespace UE::Tasks
 	template<typename T>
 	TAsyncFuture<TArray<T>> WhenAll(const TArray<TAsyncFuture<T>>& Futures) { return WhenAll<T>(Futures, EFailMode::Full); }
 
-	TAsyncFuture<void> WhenAll(const TArray<TAsyncFuture<void>>& Futures, const EFailMode FailMode)
+	inline TAsyncFuture<void> WhenAll(const TArray<TAsyncFuture<void>>& Futures, const EFailMode FailMode)
 
 	{
 		if (Futures.Num() == 0)
@@ -198,7 +198,7 @@ namespace UE::Tasks
 		return PromiseRef->GetFuture();
 	}
 
-	TAsyncFuture<void> WhenAll(const TArray<TAsyncFuture<void>>& Futures)
+	inline TAsyncFuture<void> WhenAll(const TArray<TAsyncFuture<void>>& Futures)
 	{
 		return WhenAll(Futures, EFailMode::Full);
 	}
@@ -221,19 +221,18 @@ namespace UE::Tasks
 		return PromiseRef->GetFuture();
 	}
 
-	TAsyncFuture<void> WaitAsync(const float DelayInSeconds)
+	inline TAsyncFuture<void> WaitAsync(const float DelayInSeconds)
 	{
-		const TSharedRef<TAsyncPromise<void>, ESPMode::ThreadSafe> Promise = MakeShared<TAsyncPromise<void>>();
-
-		FTSTicker::GetCoreTicker().AddTicker(
-			FTickerDelegate::CreateLambda([Promise](const float Delta)
-				{
-					Promise->SetValue();
-
-					static constexpr bool ExecuteAgain = false;
-					return ExecuteAgain;
-				}), DelayInSeconds);
+		TAsyncPromise<void> Promise;
+		Private::StartTimer(DelayInSeconds, Promise);
+		return Promise.GetFuture();
+	}
 
-		return Promise->GetFuture();
+	//Captures only this future and what's attached to it from now on, rather than every promise, until EndGraphCapture
+	template<typename T>
+	void BeginGraphCapture(const TAsyncFuture<T>& Root)
+	{
+		const auto State = Private::FFutureAccess::GetState(Root);
+		State->CaptureId = Private::BeginGraphCaptureFrom(State->IsSet());
 	}
 }
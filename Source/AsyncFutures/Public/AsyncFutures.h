@@ -3,4 +3,18 @@
 
 #include "AsyncFuture.h"
 #include "Result.h"
-#include "AsyncFutureHelpers.h"
\ No newline at end of file
+#include "AsyncFutureHelpers.h"
+#include "AsyncSemaphore.h"
+#include "AsyncChannel.h"
+#include "Coroutine.h"
+#include "TaskGroup.h"
+#include "AsyncBatch.h"
+#include "AsyncCache.h"
+#include "DiskCache.h"
+#include "Retry.h"
+#include "Coalescer.h"
+#include "BatchLoader.h"
+#include "Hedge.h"
+#include "Metrics.h"
+#include "PromiseLeaks.h"
+#include "GraphCapture.h"
\ No newline at end of file
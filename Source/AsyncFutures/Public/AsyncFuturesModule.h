@@ -5,6 +5,10 @@
 #include "Modules/ModuleInterface.h"
 #include "Modules/ModuleManager.h"
 
+#include "Metrics.h"
+
+ASYNCFUTURES_API DECLARE_LOG_CATEGORY_EXTERN(LogAsyncFutures, Log, All);
+
 /**
  * The public interface to this module
  */
@@ -33,4 +37,11 @@ public:
 	{
 		return FModuleManager::Get().IsModuleLoaded( "AsyncFutures" );
 	}
+
+	/**
+	 * Gathers the plugin's counters from every thread that has used it. Also printed by the AsyncFutures.Metrics console command.
+	 *
+	 * @return Returns live promise, scheduling, cancellation, latency and run time totals since the module started
+	 */
+	virtual UE::Tasks::FAsyncFuturesMetrics GetMetrics() const = 0;
 };
\ No newline at end of file
@@ -0,0 +1,141 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+
+// Engine Includes
+#include "Containers/Queue.h"
+#include "Misc/ScopeLock.h"
+
+// Module Includes
+#include "AsyncFuture.h"
+#include "AsyncFutureHelpers.h"
+
+namespace UE::Tasks
+{
+	namespace Private
+	{
+		class FSemaphoreState
+		{
+		public:
+			FSemaphoreState(const int32 InPermits) : Available(InPermits) {}
+
+			TAsyncFuture<void> Acquire()
+			{
+				TAsyncPromise<void> Waiter;
+				{
+					FScopeLock Lock(&CriticalSection);
+					if (Available > 0)
+					{
+						--Available;
+						Waiter.SetValue();
+					}
+					else
+					{
+						Waiters.Enqueue(TOptional<TAsyncPromise<void>>(Waiter));
+					}
+				}
+				return Waiter.GetFuture();
+			}
+
+			bool TryAcquire()
+			{
+				FScopeLock Lock(&CriticalSection);
+				if (Available > 0)
+				{
+					--Available;
+					return true;
+				}
+				return false;
+			}
+
+			void Release()
+			{
+				TOptional<TAsyncPromise<void>> Next;
+				{
+					FScopeLock Lock(&CriticalSection);
+					if (!Waiters.Dequeue(Next))
+					{
+						++Available;
+						return;
+					}
+				}
+				//Hand the permit straight over to the oldest waiter, outside the lock as this schedules its continuations
+				Next->SetValue();
+			}
+
+			int32 GetAvailable() const
+			{
+				FScopeLock Lock(&CriticalSection);
+				return Available;
+			}
+
+		private:
+			mutable FCriticalSection CriticalSection;
+			int32 Available;
+			TQueue<TOptional<TAsyncPromise<void>>> Waiters;
+		};
+
+		//Returns the permit when the last copy of the work holding it is destroyed, whether it ran, was cancelled or its owner expired
+		class FSemaphorePermit
+		{
+		public:
+			FSemaphorePermit(const TSharedRef<FSemaphoreState, ESPMode::ThreadSafe>& InState) : State(InState) {}
+			~FSemaphorePermit() { State->Release(); }
+		private:
+			TSharedRef<FSemaphoreState, ESPMode::ThreadSafe> State;
+		};
+
+		template<typename F>
+		auto HoldPermit(const TSharedRef<FSemaphorePermit, ESPMode::ThreadSafe>& Permit, F&& Function)
+		{
+			return [Permit, Function = Forward<F>(Function)]() mutable
+			{
+				using ReturnType = decltype(Function());
+				if constexpr (TIsFuture<ReturnType>::Value)
+				{
+					//Asynchronous work keeps the permit until its own future completes
+					return Function().Then([Permit](const TResult<TUnwrap_T<ReturnType>>& Result) { return Result; });
+				}
+				else
+				{
+					return Function();
+				}
+			};
+		}
+	}
+
+	//Copyable handle to a counting semaphore whose waiters are futures rather than blocked threads
+	class FAsyncSemaphore
+	{
+	public:
+		FAsyncSemaphore(const int32 Permits)
+			: State(MakeShared<Private::FSemaphoreState, ESPMode::ThreadSafe>(Permits))
+		{
+			check(Permits > 0);
+		}
+
+		FAsyncSemaphore(const FAsyncSemaphore& Other) = default;
+		FAsyncSemaphore& operator=(const FAsyncSemaphore& Other) = default;
+		FAsyncSemaphore(FAsyncSemaphore&& Other) = default;
+		FAsyncSemaphore& operator=(FAsyncSemaphore&& Other) = default;
+
+		//Completes once a permit is held. Every acquired permit needs a matching Release
+		TAsyncFuture<void> Acquire() const { return State->Acquire(); }
+		bool TryAcquire() const { return State->TryAcquire(); }
+		void Release() const { State->Release(); }
+		int32 GetAvailable() const { return State->GetAvailable(); }
+
+		//Runs the function as Async would once a permit is available, and releases it when the function (or the future it returns) completes
+		template<typename F>
+		auto Run(F&& Function, const FOptions& Options = FOptions()) const
+		{
+			return Acquire().Then([State = State, Function = Forward<F>(Function), Options]() mutable
+			{
+				const TSharedRef<Private::FSemaphorePermit, ESPMode::ThreadSafe> Permit = MakeShared<Private::FSemaphorePermit, ESPMode::ThreadSafe>(State);
+				return Async(Private::HoldPermit(Permit, MoveTemp(Function)), Options);
+			});
+		}
+
+	private:
+		TSharedRef<Private::FSemaphoreState, ESPMode::ThreadSafe> State;
+	};
+}
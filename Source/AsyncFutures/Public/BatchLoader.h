@@ -0,0 +1,204 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+
+// Engine Includes
+#include "Containers/Map.h"
+#include "Misc/ScopeLock.h"
+
+// Module Includes
+#include "AsyncFuture.h"
+#include "AsyncFutureHelpers.h"
+#include "Timer.h"
+
+namespace UE::Tasks
+{
+	inline uint64 ERROR_BATCH_MISSING_KEY = 5;
+
+	namespace Private
+	{
+		template<typename K, typename V>
+		class TBatchLoaderState : public TSharedFromThis<TBatchLoaderState<K, V>, ESPMode::ThreadSafe>
+		{
+			using FBatch = TMap<K, TAsyncPromise<V>>;
+
+		public:
+			TBatchLoaderState(TUniqueFunction<TAsyncFuture<TMap<K, V>>(const TArray<K>&)>&& InBatchFunction, const int32 InMaxBatchSize, const double InWindow, const FOptions& InOptions)
+				: BatchFunction(MoveTemp(InBatchFunction))
+				, MaxBatchSize(InMaxBatchSize)
+				, Window(InWindow)
+				, Options(InOptions)
+			{
+			}
+
+			~TBatchLoaderState()
+			{
+				//Loads still waiting for their window when the last handle goes
+				for (const TPair<K, TAsyncPromise<V>>& Entry : Queued)
+				{
+					Entry.Value.Cancel();
+				}
+			}
+
+			TAsyncFuture<V> Load(const K& Key)
+			{
+				FBatch Full;
+				TAsyncFuture<V> Future;
+				{
+					FScopeLock Lock(&CriticalSection);
+					//The same key twice in one batch is only loaded once
+					if (TAsyncPromise<V>* Existing = Queued.Find(Key))
+					{
+						return Existing->GetFuture();
+					}
+
+					Future = Queued.Add(Key).GetFuture();
+					if (Queued.Num() >= MaxBatchSize)
+					{
+						Full = TakeLocked();
+					}
+					else if (Queued.Num() == 1)
+					{
+						StartWindowLocked();
+					}
+				}
+
+				if (Full.Num() > 0)
+				{
+					Launch(MoveTemp(Full));
+				}
+				return Future;
+			}
+
+			void Flush()
+			{
+				FBatch Batch;
+				{
+					FScopeLock Lock(&CriticalSection);
+					Batch = TakeLocked();
+				}
+
+				if (Batch.Num() > 0)
+				{
+					Launch(MoveTemp(Batch));
+				}
+			}
+
+		private:
+			void StartWindowLocked()
+			{
+				const TAsyncPromise<void> Timer;
+				typename TPromiseState<void>::FCallback OnElapsed = [WeakState = TWeakPtr<TBatchLoaderState, ESPMode::ThreadSafe>(this->AsShared()), Generation = BatchGeneration](const TResult<void>&)
+				{
+					if (const TSharedPtr<TBatchLoaderState, ESPMode::ThreadSafe> State = WeakState.Pin())
+					{
+						State->WindowElapsed(Generation);
+					}
+				};
+				if (!Timer.State->AddCallback(MoveTemp(OnElapsed)))
+				{
+					OnElapsed(Timer.Get());
+				}
+				StartTimer(Window, Timer);
+			}
+
+			void WindowElapsed(const uint64 Generation)
+			{
+				FBatch Batch;
+				{
+					FScopeLock Lock(&CriticalSection);
+					//The batch this window was started for already filled up and went
+					if (Generation != BatchGeneration)
+					{
+						return;
+					}
+					Batch = TakeLocked();
+				}
+
+				if (Batch.Num() > 0)
+				{
+					Launch(MoveTemp(Batch));
+				}
+			}
+
+			FBatch TakeLocked()
+			{
+				++BatchGeneration;
+				FBatch Batch = MoveTemp(Queued);
+				Queued.Reset();
+				return Batch;
+			}
+
+			void Launch(FBatch&& Batch)
+			{
+				Dispatch(Options, [State = this->AsShared(), Batch = MoveTemp(Batch)]() mutable
+				{
+					TArray<K> Keys;
+					Batch.GenerateKeyArray(Keys);
+
+					TAsyncFuture<TMap<K, V>> Future = State->BatchFunction(Keys);
+					const TSharedRef<TPromiseState<TMap<K, V>>, ESPMode::ThreadSafe> FutureState = FFutureAccess::GetState(Future);
+					typename TPromiseState<TMap<K, V>>::FCallback OnLoaded = [Promises = MoveTemp(Batch)](const TResult<TMap<K, V>>& Result)
+					{
+						for (const TPair<K, TAsyncPromise<V>>& Entry : Promises)
+						{
+							if (Result.HasError())
+							{
+								Entry.Value.SetValue(Result.GetError());
+							}
+							else if (const V* Value = Result.GetValue().Find(Entry.Key))
+							{
+								Entry.Value.SetValue(*Value);
+							}
+							else
+							{
+								Entry.Value.SetValue(FError(ERROR_CONTEXT_FUTURE, ERROR_BATCH_MISSING_KEY, TEXT("Batch function didn't return a value for the key")));
+							}
+						}
+					};
+					if (!FutureState->AddCallback(MoveTemp(OnLoaded)))
+					{
+						OnLoaded(FutureState->Get());
+					}
+					FutureState->Start();
+				});
+			}
+
+			TUniqueFunction<TAsyncFuture<TMap<K, V>>(const TArray<K>&)> BatchFunction;
+			const int32 MaxBatchSize;
+			const double Window;
+			const FOptions Options;
+
+			FCriticalSection CriticalSection;
+			FBatch Queued;
+			uint64 BatchGeneration = 0;
+		};
+	}
+
+	//Copyable handle that gathers individual loads into batches. Every Load returns its own future straight away, and the keys are
+	//collected until the batch is full or the window since the first of them has passed, then the batch function is called once with
+	//all of them. Keys missing from the map it returns complete with ERROR_BATCH_MISSING_KEY, and an error fails the whole batch.
+	//Batches aren't serialized, so the batch function may be called again before an earlier batch completes.
+	template<typename K, typename V>
+	class TAsyncBatchLoader
+	{
+	public:
+		//A window of zero collects everything loaded until the next tick of the core ticker
+		TAsyncBatchLoader(TUniqueFunction<TAsyncFuture<TMap<K, V>>(const TArray<K>&)> BatchFunction, const int32 MaxBatchSize = 64, const double Window = 0.0, const FOptions& Options = FOptions())
+			: State(MakeShared<Private::TBatchLoaderState<K, V>, ESPMode::ThreadSafe>(MoveTemp(BatchFunction), FMath::Max(MaxBatchSize, 1), Window, Options))
+		{
+		}
+
+		TAsyncBatchLoader(const TAsyncBatchLoader& Other) = default;
+		TAsyncBatchLoader& operator=(const TAsyncBatchLoader& Other) = default;
+		TAsyncBatchLoader(TAsyncBatchLoader&& Other) = default;
+		TAsyncBatchLoader& operator=(TAsyncBatchLoader&& Other) = default;
+
+		TAsyncFuture<V> Load(const K& Key) const { return State->Load(Key); }
+
+		//Sends whatever has been collected without waiting for the window
+		void Flush() const { State->Flush(); }
+
+	private:
+		TSharedRef<Private::TBatchLoaderState<K, V>, ESPMode::ThreadSafe> State;
+	};
+}
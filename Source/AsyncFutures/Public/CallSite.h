@@ -0,0 +1,73 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+
+// Engine Includes
+#include "Containers/Array.h"
+#include "CoreTypes.h"
+#include "HAL/PlatformTime.h"
+
+namespace UE::Tasks
+{
+	//Where a Then or Async was called from. Defaulted parameters capture the caller's location without any macro at the call site.
+	//Explicit so a stray string can't turn into a call site, such as FOptions().Set("Name") or an extra argument to Then
+	struct FCallSite
+	{
+		explicit FCallSite(const ANSICHAR* InFile = __builtin_FILE(), const int32 InLine = __builtin_LINE())
+			: File(InFile)
+			, Line(InLine)
+		{}
+
+		const ANSICHAR* File;
+		int32 Line;
+	};
+
+	//Estimated totals for one call site, scaled up by the sample rate they were recorded at
+	struct FCallSiteStats
+	{
+		FString File;
+		int32 Line = 0;
+		uint64 Count = 0;
+		double CpuSeconds = 0.0; //Running the continuation
+		double WaitSeconds = 0.0; //From the stage it depends on being ready to it starting
+	};
+
+	//Call sites with the most CPU time first
+	ASYNCFUTURES_API TArray<FCallSiteStats> GetCallSiteReport();
+	ASYNCFUTURES_API void ResetCallSiteReport();
+
+	namespace Private
+	{
+		//Weight to record the next continuation with, or 0 when it isn't sampled. Controlled by AsyncFutures.CallSites.SampleRate
+		ASYNCFUTURES_API int32 SampleCallSite();
+		ASYNCFUTURES_API void RecordCallSite(const FCallSite& CallSite, const int32 Weight, const uint64 ReadyCycles, const uint64 StartCycles, const uint64 EndCycles);
+
+		class FCallSiteScope
+		{
+		public:
+			FCallSiteScope(const FCallSite* InCallSite, const int32 InWeight, const uint64 InReadyCycles)
+				: CallSite(InWeight > 0 ? InCallSite : nullptr)
+				, Weight(InWeight)
+				, ReadyCycles(InReadyCycles)
+				, StartCycles(CallSite != nullptr ? FPlatformTime::Cycles64() : 0)
+			{
+			}
+
+			~FCallSiteScope()
+			{
+				if (CallSite != nullptr)
+				{
+					RecordCallSite(*CallSite, Weight, ReadyCycles, StartCycles, FPlatformTime::Cycles64());
+				}
+			}
+
+			FCallSiteScope(const FCallSiteScope&) = delete;
+			FCallSiteScope& operator=(const FCallSiteScope&) = delete;
+
+		private:
+			const FCallSite* CallSite;
+			const int32 Weight;
+			const uint64 ReadyCycles;
+			const uint64 StartCycles;
+		};
+	}
+}
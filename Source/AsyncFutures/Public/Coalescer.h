@@ -0,0 +1,146 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+
+// Engine Includes
+#include "Misc/ScopeLock.h"
+
+// Module Includes
+#include "AsyncFuture.h"
+#include "AsyncFutureHelpers.h"
+#include "Timer.h"
+
+namespace UE::Tasks
+{
+	namespace Private
+	{
+		template<typename T>
+		class TCoalescerState : public TSharedFromThis<TCoalescerState<T>, ESPMode::ThreadSafe>
+		{
+		public:
+			TCoalescerState(TUniqueFunction<TAsyncFuture<T>()>&& InFactory, const double InWindow, const FOptions& InOptions)
+				: Factory(MoveTemp(InFactory))
+				, Window(InWindow)
+				, Options(InOptions)
+			{
+			}
+
+			TAsyncFuture<T> Trigger()
+			{
+				FScopeLock Lock(&CriticalSection);
+				if (!Pending.IsSet())
+				{
+					Pending.Emplace();
+					++NumRuns;
+					//A run in flight may already have read the state that changed, so later triggers wait for the next one
+					if (!bRunning)
+					{
+						ScheduleLocked();
+					}
+				}
+				++NumTriggers;
+				return Pending->GetFuture();
+			}
+
+			int32 GetNumTriggers() const
+			{
+				FScopeLock Lock(&CriticalSection);
+				return NumTriggers;
+			}
+
+			int32 GetNumRuns() const
+			{
+				FScopeLock Lock(&CriticalSection);
+				return NumRuns;
+			}
+
+		private:
+			void ScheduleLocked()
+			{
+				bRunning = true;
+				if (Window <= 0.0)
+				{
+					Dispatch(Options, [State = this->AsShared()]() { State->Run(); });
+					return;
+				}
+
+				const TAsyncPromise<void> Timer;
+				typename TPromiseState<void>::FCallback OnElapsed = [State = this->AsShared()](const TResult<void>&)
+				{
+					Dispatch(State->Options, [State]() { State->Run(); });
+				};
+				if (!Timer.State->AddCallback(MoveTemp(OnElapsed)))
+				{
+					OnElapsed(Timer.Get());
+				}
+				StartTimer(Window, Timer);
+			}
+
+			void Run()
+			{
+				TOptional<TAsyncPromise<T>> Taken;
+				{
+					FScopeLock Lock(&CriticalSection);
+					Taken = MoveTemp(Pending);
+					Pending.Reset();
+				}
+
+				TAsyncFuture<T> Future = Factory();
+				const TSharedRef<TPromiseState<T>, ESPMode::ThreadSafe> FutureState = FFutureAccess::GetState(Future);
+				typename TPromiseState<T>::FCallback OnCompleted = [State = this->AsShared(), Promise = MoveTemp(Taken.GetValue())](const TResult<T>& Result)
+				{
+					{
+						FScopeLock Lock(&State->CriticalSection);
+						State->bRunning = false;
+						if (State->Pending.IsSet())
+						{
+							State->ScheduleLocked();
+						}
+					}
+					Promise.SetValue(Result);
+				};
+				if (!FutureState->AddCallback(MoveTemp(OnCompleted)))
+				{
+					OnCompleted(FutureState->Get());
+				}
+				FutureState->Start();
+			}
+
+			TUniqueFunction<TAsyncFuture<T>()> Factory;
+			const double Window;
+			const FOptions Options;
+
+			mutable FCriticalSection CriticalSection;
+			TOptional<TAsyncPromise<T>> Pending; //The run every trigger since the last one started is waiting on
+			bool bRunning = false; //Scheduled or running, only one run is ever in flight
+			int32 NumTriggers = 0;
+			int32 NumRuns = 0;
+		};
+	}
+
+	//Copyable handle that merges bursts of triggers into single runs of a factory returning a TAsyncFuture. The first trigger schedules a run
+	//after the window, and every trigger until it starts shares its future. Triggers while a run is in flight are merged into one more run
+	//once it finishes, so the result always reflects every trigger that came before it.
+	template<typename T>
+	class TAsyncCoalescer
+	{
+	public:
+		//A window of zero or less runs as soon as the options' execution picks it up
+		TAsyncCoalescer(TUniqueFunction<TAsyncFuture<T>()> Factory, const double Window = 0.0, const FOptions& Options = FOptions())
+			: State(MakeShared<Private::TCoalescerState<T>, ESPMode::ThreadSafe>(MoveTemp(Factory), Window, Options))
+		{
+		}
+
+		TAsyncCoalescer(const TAsyncCoalescer& Other) = default;
+		TAsyncCoalescer& operator=(const TAsyncCoalescer& Other) = default;
+		TAsyncCoalescer(TAsyncCoalescer&& Other) = default;
+		TAsyncCoalescer& operator=(TAsyncCoalescer&& Other) = default;
+
+		TAsyncFuture<T> Trigger() const { return State->Trigger(); }
+
+		int32 GetNumTriggers() const { return State->GetNumTriggers(); }
+		int32 GetNumRuns() const { return State->GetNumRuns(); }
+
+	private:
+		TSharedRef<Private::TCoalescerState<T>, ESPMode::ThreadSafe> State;
+	};
+}
@@ -0,0 +1,147 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define WITH_ASYNCFUTURES_COROUTINES 1
+#else
+#define WITH_ASYNCFUTURES_COROUTINES 0
+#endif
+
+#if WITH_ASYNCFUTURES_COROUTINES
+#include <coroutine>
+
+// Engine Includes
+#include "HAL/UnrealMemory.h"
+
+// Module Includes
+#include "AsyncFuture.h"
+
+namespace UE::Tasks
+{
+	namespace Private
+	{
+		//Suspends until the future is fulfilled. Without options the coroutine is resumed directly by whoever fulfils the future,
+		//with options the resumption is dispatched to the thread or executor they select.
+		template<typename T>
+		class TFutureAwaiter
+		{
+		public:
+			TFutureAwaiter(const TAsyncFuture<T>& Future, TOptional<FOptions>&& InResumeOptions = TOptional<FOptions>())
+				: State(FFutureAccess::GetState(Future))
+				, ResumeOptions(MoveTemp(InResumeOptions))
+			{
+				State->Start();
+			}
+
+			//Ready futures don't suspend at all, unless we were asked to move to another thread
+			bool await_ready() const { return !ResumeOptions.IsSet() && State->IsSet(); }
+
+			bool await_suspend(std::coroutine_handle<> Handle)
+			{
+				typename TPromiseState<T>::FCallback Resume = [Handle, Options = ResumeOptions](const TResult<T>&)
+				{
+					if (Options.IsSet())
+					{
+						Dispatch(Options.GetValue(), [Handle]() { Handle.resume(); });
+					}
+					else
+					{
+						Handle.resume();
+					}
+				};
+
+				//The callback may already be running on another thread once it's added, so nothing here can touch the frame afterwards
+				if (State->AddCallback(MoveTemp(Resume)))
+				{
+					return true;
+				}
+
+				if (ResumeOptions.IsSet())
+				{
+					Resume(State->Get());
+					return true;
+				}
+				return false;
+			}
+
+			TResult<T> await_resume() const { return State->Get(); }
+
+		private:
+			TSharedRef<TPromiseState<T>, ESPMode::ThreadSafe> State;
+			TOptional<FOptions> ResumeOptions;
+		};
+
+		class FSwitchToAwaiter
+		{
+		public:
+			FSwitchToAwaiter(const FOptions& InOptions) : Options(InOptions) {}
+
+			bool await_ready() const { return false; }
+			void await_suspend(std::coroutine_handle<> Handle) { Dispatch(Options, [Handle]() { Handle.resume(); }); }
+			void await_resume() const {}
+
+		private:
+			FOptions Options;
+		};
+
+		//The coroutine frame owns the promise, and runs until its first suspension on the thread that called it
+		template<typename T>
+		class TCoroutinePromiseBase
+		{
+		public:
+			TAsyncFuture<T> get_return_object() { return Promise.GetFuture(); }
+			std::suspend_never initial_suspend() const noexcept { return {}; }
+			std::suspend_never final_suspend() const noexcept { return {}; }
+			void unhandled_exception() const { checkNoEntry(); }
+
+			static void* operator new(const size_t Size) { return FMemory::Malloc(Size); }
+			static void operator delete(void* Frame) { FMemory::Free(Frame); }
+
+		protected:
+			TAsyncPromise<T> Promise;
+		};
+
+		template<typename T>
+		class TCoroutinePromise : public TCoroutinePromiseBase<T>
+		{
+		public:
+			template<typename V>
+			void return_value(V&& Value) { this->Promise.SetValue(Forward<V>(Value)); }
+		};
+
+		template<>
+		class TCoroutinePromise<void> : public TCoroutinePromiseBase<void>
+		{
+		public:
+			void return_void() { Promise.SetValue(); }
+		};
+	}
+
+	//co_await Future resumes on whichever thread fulfils it, and yields its TResult
+	template<typename T>
+	Private::TFutureAwaiter<T> operator co_await(const TAsyncFuture<T>& Future)
+	{
+		return Private::TFutureAwaiter<T>(Future);
+	}
+
+	//co_await ResumeOn(Future, Options) resumes on the thread or executor chosen in the options once the future is fulfilled
+	template<typename T>
+	Private::TFutureAwaiter<T> ResumeOn(const TAsyncFuture<T>& Future, const FOptions& Options)
+	{
+		return Private::TFutureAwaiter<T>(Future, TOptional<FOptions>(Options));
+	}
+
+	//co_await SwitchTo(Options) moves the rest of the coroutine to the thread or executor chosen in the options
+	inline Private::FSwitchToAwaiter SwitchTo(const FOptions& Options)
+	{
+		return Private::FSwitchToAwaiter(Options);
+	}
+}
+
+//Any function returning a TAsyncFuture can be a coroutine, the future completes with the value it co_returns
+template<typename T, typename... ArgTypes>
+struct std::coroutine_traits<UE::Tasks::TAsyncFuture<T>, ArgTypes...>
+{
+	using promise_type = UE::Tasks::Private::TCoroutinePromise<T>;
+};
+#endif
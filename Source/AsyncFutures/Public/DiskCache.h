@@ -0,0 +1,76 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+
+// Engine Includes
+#include "Containers/ArrayView.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+// Module Includes
+#include "AsyncFuture.h"
+#include "AsyncFutureHelpers.h"
+
+namespace UE::Tasks
+{
+	//Copyable handle to a directory of serialized results, addressed by a hash of their key and the cache version.
+	//Entries are read through a memory mapping and written to a temporary file that's renamed into place, so readers never see a partial entry.
+	class ASYNCFUTURES_API FAsyncDiskCache
+	{
+	public:
+		//Changing the version invalidates every entry, bump it whenever the serialized format of a cached type changes
+		FAsyncDiskCache(const FString& InDirectory, const FString& InVersion = FString());
+
+		//Resolves from disk when the key is cached, otherwise runs the factory and stores its value. T is serialized with operator<<,
+		//and errors are never stored. Loading and storing happen on the options' execution, a thread pool by default.
+		template<typename T, typename F>
+		TAsyncFuture<T> GetOrCompute(const FString& Key, F&& Factory, const FOptions Options = FOptions().Set(EAsyncExecution::ThreadPool)) const
+		{
+			return Async([Cache = *this, Key, Factory = Forward<F>(Factory), Options]() mutable
+			{
+				TOptional<T> Cached;
+				Cache.Load(Key, [&Cached](TArrayView<const uint8> Payload)
+				{
+					FMemoryReaderView Reader(Payload);
+					T Value;
+					Reader << Value;
+					if (Reader.IsError())
+					{
+						return false;
+					}
+					Cached.Emplace(MoveTemp(Value));
+					return true;
+				});
+
+				if (Cached.IsSet())
+				{
+					return MakeReadyFuture<T>(MoveTemp(Cached.GetValue()));
+				}
+
+				return Factory().Then([Cache, Key](const TResult<T>& Result)
+				{
+					if (Result.HasValue())
+					{
+						TArray<uint8> Payload;
+						FMemoryWriter Writer(Payload);
+						T Value = Result.GetValue();
+						Writer << Value;
+						Cache.Store(Key, Payload);
+					}
+					return Result;
+				}, Options);
+			}, Options);
+		}
+
+		//Calls the reader with the stored payload, returns false when there's no valid entry or the reader rejects it
+		bool Load(const FString& Key, TFunctionRef<bool(TArrayView<const uint8>)> Reader) const;
+		//Returns false without writing anything for payloads too big to load back, just under 2GB
+		bool Store(const FString& Key, TArrayView<const uint8> Payload) const;
+		bool Remove(const FString& Key) const;
+
+		FString GetPath(const FString& Key) const;
+
+	private:
+		FString Directory;
+		FString Version;
+	};
+}
@@ -0,0 +1,118 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+
+// Engine Includes
+#include "Containers/Array.h"
+#include "Containers/UnrealString.h"
+#include "CoreTypes.h"
+#include "HAL/PlatformTime.h"
+
+// Module Includes
+#include "CallSite.h"
+
+namespace UE::Tasks
+{
+	enum class EFutureGraphEdge : uint8
+	{
+		Continuation, //A Then waiting on the promise before it
+		Forwarded //A future returned by a continuation, which fulfils the continuation's promise
+	};
+
+	//Times are in milliseconds since the capture began, negative when it didn't happen while capturing
+	struct FFutureGraphNode
+	{
+		int32 Id = 0;
+		FString Name; //From FOptions, empty when the work wasn't named
+		FString File;
+		int32 Line = 0;
+		FString Thread; //Where the continuation ran, empty for promises fulfilled by hand
+		double CreatedMs = -1.0;
+		double ReadyMs = -1.0; //When the promise the continuation waits on was fulfilled
+		double StartedMs = -1.0;
+		double EndedMs = -1.0;
+		double FulfilledMs = -1.0;
+		int32 CreatedBy = 0; //The continuation that was running when the promise was created, 0 when it wasn't a captured one
+		int32 FulfilledBy = 0; //The continuation that fulfilled the promise, when it wasn't the promise's own
+		bool bError = false;
+		bool bCritical = false;
+	};
+
+	struct FFutureGraphEdge
+	{
+		int32 From = 0;
+		int32 To = 0;
+		EFutureGraphEdge Kind = EFutureGraphEdge::Continuation;
+		bool bCritical = false;
+	};
+
+	struct ASYNCFUTURES_API FFutureGraph
+	{
+		TArray<FFutureGraphNode> Nodes;
+		TArray<FFutureGraphEdge> Edges;
+		//Node ids from the start of the chain that held up the last promise to be fulfilled, to that promise
+		TArray<int32> CriticalPath;
+		double DurationMs = 0.0;
+
+		//Graphviz, with the critical path in red
+		FString ToDot() const;
+		FString ToJson() const;
+		//Writes BasePath.dot and BasePath.json
+		bool Save(const FString& BasePath) const;
+	};
+
+	//Records every promise created, and every Then attached, until the capture ends. Restarts a capture that's already running
+	ASYNCFUTURES_API void BeginGraphCapture();
+	//Stops capturing and works out the critical path. Empty when nothing was being captured
+	ASYNCFUTURES_API FFutureGraph EndGraphCapture();
+	ASYNCFUTURES_API bool IsCapturingGraph();
+	//Saved/AsyncFutures/Graphs
+	ASYNCFUTURES_API FString GetDefaultGraphDirectory();
+
+	namespace Private
+	{
+		//Node for a promise created while a windowed capture is running, otherwise 0
+		ASYNCFUTURES_API uint64 CapturePromiseCreated();
+		ASYNCFUTURES_API void CaptureCallSite(const uint64 NodeId, const FCallSite& CallSite);
+		ASYNCFUTURES_API void CapturePromiseFulfilled(const uint64 NodeId, const bool bError);
+		//Links a continuation to the promise it waits on and returns the continuation's node. Continuations of a captured promise are always captured
+		ASYNCFUTURES_API uint64 CaptureContinuation(const uint64 AntecedentId, const uint64 NodeId, const TCHAR* Name, const FCallSite* CallSite);
+		//Links the future a continuation returned to the continuation's promise, and returns the future's node
+		ASYNCFUTURES_API uint64 CaptureForwarded(const uint64 FutureId, const uint64 NodeId, const bool bFutureSet);
+		//Leaves a node the module only created for its own plumbing out of the graph
+		ASYNCFUTURES_API void DiscardCapturedNode(const uint64 NodeId);
+		//Starts a capture of only the given promise and what's attached to it from now on, returns the promise's node
+		ASYNCFUTURES_API uint64 BeginGraphCaptureFrom(const bool bSet);
+		ASYNCFUTURES_API void CaptureExecution(const uint64 NodeId, const uint64 StartCycles, const uint64 EndCycles);
+		//Marks the continuation running on this thread, so the promises it creates and fulfils can be attributed to it. Returns the one it replaces
+		ASYNCFUTURES_API uint64 SetRunningCapturedNode(const uint64 NodeId);
+
+		//Brackets a captured continuation running
+		class FGraphCaptureScope
+		{
+		public:
+			explicit FGraphCaptureScope(const uint64 InNodeId)
+				: NodeId(InNodeId)
+				, OuterNodeId(InNodeId != 0 ? SetRunningCapturedNode(InNodeId) : 0)
+				, StartCycles(InNodeId != 0 ? FPlatformTime::Cycles64() : 0)
+			{
+			}
+
+			~FGraphCaptureScope()
+			{
+				if (NodeId != 0)
+				{
+					SetRunningCapturedNode(OuterNodeId);
+					CaptureExecution(NodeId, StartCycles, FPlatformTime::Cycles64());
+				}
+			}
+
+			FGraphCaptureScope(const FGraphCaptureScope&) = delete;
+			FGraphCaptureScope& operator=(const FGraphCaptureScope&) = delete;
+
+		private:
+			const uint64 NodeId;
+			const uint64 OuterNodeId;
+			const uint64 StartCycles;
+		};
+	}
+}
@@ -0,0 +1,273 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+#include <atomic>
+#include <type_traits>
+
+// Engine Includes
+#include "Misc/ScopeLock.h"
+
+// Module Includes
+#include "AsyncFuture.h"
+#include "AsyncFutureHelpers.h"
+#include "Timer.h"
+
+namespace UE::Tasks
+{
+	namespace Private
+	{
+		class FLatencyTrackerState
+		{
+		public:
+			FLatencyTrackerState(const int32 InCapacity)
+				: Capacity(InCapacity)
+			{
+				Samples.Reserve(Capacity);
+			}
+
+			void AddSample(const double Seconds)
+			{
+				FScopeLock Lock(&CriticalSection);
+				if (Samples.Num() < Capacity)
+				{
+					Samples.Add(Seconds);
+				}
+				else
+				{
+					Samples[NextIndex] = Seconds;
+				}
+				NextIndex = (NextIndex + 1) % Capacity;
+			}
+
+			double GetPercentile(const double Percentile) const
+			{
+				TArray<double> Sorted;
+				{
+					FScopeLock Lock(&CriticalSection);
+					Sorted = Samples;
+				}
+				if (Sorted.Num() == 0)
+				{
+					return 0.0;
+				}
+
+				Sorted.Sort();
+				const int32 Index = FMath::Clamp(FMath::CeilToInt32(FMath::Clamp(Percentile, 0.0, 1.0) * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+				return Sorted[Index];
+			}
+
+			int32 Num() const
+			{
+				FScopeLock Lock(&CriticalSection);
+				return Samples.Num();
+			}
+
+		private:
+			const int32 Capacity;
+			mutable FCriticalSection CriticalSection;
+			TArray<double> Samples;
+			int32 NextIndex = 0;
+		};
+	}
+
+	//Copyable handle to a rolling window of the most recent latencies, in seconds
+	class FLatencyTracker
+	{
+	public:
+		FLatencyTracker(const int32 Capacity = 256) : State(MakeShared<Private::FLatencyTrackerState, ESPMode::ThreadSafe>(FMath::Max(Capacity, 1))) {}
+
+		FLatencyTracker(const FLatencyTracker& Other) = default;
+		FLatencyTracker& operator=(const FLatencyTracker& Other) = default;
+		FLatencyTracker(FLatencyTracker&& Other) = default;
+		FLatencyTracker& operator=(FLatencyTracker&& Other) = default;
+
+		void AddSample(const double Seconds) const { State->AddSample(Seconds); }
+
+		//Percentile between 0 and 1, zero when nothing has been recorded
+		double GetPercentile(const double Percentile) const { return State->GetPercentile(Percentile); }
+		int32 Num() const { return State->Num(); }
+
+	private:
+		TSharedRef<Private::FLatencyTrackerState, ESPMode::ThreadSafe> State;
+	};
+
+	//When Hedge starts a backup attempt. With a tracker that has enough samples the backup starts once the first attempt has taken longer
+	//than the percentile of recent latencies, otherwise after the fixed delay. Winning latencies are recorded into the tracker.
+	struct FHedgePolicy
+	{
+		double Delay = 0.05;
+		TOptional<FLatencyTracker> Tracker;
+		double Percentile = 0.95;
+		int32 MinSamples = 20;
+		int32 MaxAttempts = 2;
+
+		double GetDelay() const
+		{
+			if (Tracker.IsSet() && Tracker->Num() >= MinSamples)
+			{
+				return Tracker->GetPercentile(Percentile);
+			}
+			return Delay;
+		}
+	};
+
+	namespace Private
+	{
+		template<typename T, typename F>
+		class THedgeState : public TSharedFromThis<THedgeState<T, F>, ESPMode::ThreadSafe>
+		{
+		public:
+			THedgeState(F&& InFactory, const FHedgePolicy& InPolicy, const FOptions& InOptions)
+				: Factory(Forward<F>(InFactory))
+				, Policy(InPolicy)
+				, Options(InOptions)
+			{
+				const TOptional<FCancellationHandle>& Cancellation = Options.GetCancellation();
+				if (Cancellation.IsSet())
+				{
+					FCancellationHandle Handle = Cancellation.GetValue();
+					Handle.Bind(Promise);
+				}
+			}
+
+			TAsyncFuture<T> GetFuture() { return Promise.GetFuture(); }
+
+			void Start()
+			{
+				//However the hedge completes, won, failed or cancelled, every attempt still running is a loser.
+				//Weak, as the promise is owned by the state. Attempts still running keep it alive themselves
+				const TWeakPtr<THedgeState, ESPMode::ThreadSafe> WeakState = this->AsShared();
+				typename TPromiseState<T>::FCallback OnCompleted = [WeakState](const TResult<T>&)
+				{
+					if (const TSharedPtr<THedgeState, ESPMode::ThreadSafe> State = WeakState.Pin())
+					{
+						State->CancelAttempts();
+					}
+				};
+				if (!Promise.State->AddCallback(MoveTemp(OnCompleted)))
+				{
+					return;
+				}
+				LaunchAttempt();
+			}
+
+		private:
+			void LaunchAttempt()
+			{
+				FCancellationHandle Handle;
+				{
+					FScopeLock Lock(&CriticalSection);
+					//There's always a first attempt, or the hedge would never complete
+					if (Promise.IsSet() || Handles.Num() >= FMath::Max(Policy.MaxAttempts, 1))
+					{
+						return;
+					}
+					Handles.Add(Handle);
+					++Outstanding;
+				}
+
+				Dispatch(Options, [State = this->AsShared(), Handle]()
+				{
+					State->RunAttempt(Handle);
+				});
+				StartHedgeTimer();
+			}
+
+			void StartHedgeTimer()
+			{
+				const TAsyncPromise<void> Timer;
+				typename TPromiseState<void>::FCallback OnElapsed = [State = this->AsShared()](const TResult<void>&)
+				{
+					State->LaunchAttempt();
+				};
+				if (!Timer.State->AddCallback(MoveTemp(OnElapsed)))
+				{
+					OnElapsed(Timer.Get());
+				}
+				StartTimer(Policy.GetDelay(), Timer);
+			}
+
+			void RunAttempt(const FCancellationHandle& Handle)
+			{
+				if (Promise.IsSet())
+				{
+					return;
+				}
+
+				const double StartTime = FPlatformTime::Seconds();
+				TAsyncFuture<T> Future = Factory(Handle);
+				const TSharedRef<TPromiseState<T>, ESPMode::ThreadSafe> FutureState = FFutureAccess::GetState(Future);
+				typename TPromiseState<T>::FCallback OnCompleted = [State = this->AsShared(), StartTime](const TResult<T>& Result)
+				{
+					State->AttemptCompleted(Result, FPlatformTime::Seconds() - StartTime);
+				};
+				if (!FutureState->AddCallback(MoveTemp(OnCompleted)))
+				{
+					OnCompleted(FutureState->Get());
+				}
+				FutureState->Start();
+			}
+
+			void AttemptCompleted(const TResult<T>& Result, const double Latency)
+			{
+				if (Result.HasValue())
+				{
+					if (!Promise.IsSet() && Policy.Tracker.IsSet())
+					{
+						Policy.Tracker->AddSample(Latency);
+					}
+					Promise.SetValue(Result);
+					return;
+				}
+
+				//An error only completes the hedge once no other attempt is left that could still succeed
+				bool bLastAttempt = false;
+				{
+					FScopeLock Lock(&CriticalSection);
+					bLastAttempt = --Outstanding == 0;
+				}
+				if (bLastAttempt)
+				{
+					Promise.SetValue(Result);
+				}
+			}
+
+			void CancelAttempts()
+			{
+				TArray<FCancellationHandle> ToCancel;
+				{
+					FScopeLock Lock(&CriticalSection);
+					ToCancel = Handles;
+				}
+				for (FCancellationHandle& Handle : ToCancel)
+				{
+					Handle.Cancel();
+				}
+			}
+
+			std::remove_cv_t<typename TRemoveReference<F>::Type> Factory;
+			const FHedgePolicy Policy;
+			const FOptions Options;
+			TAsyncPromise<T> Promise;
+
+			FCriticalSection CriticalSection;
+			TArray<FCancellationHandle> Handles;
+			int32 Outstanding = 0;
+		};
+	}
+
+	//Calls the factory, which takes the FCancellationHandle for its attempt and returns a TAsyncFuture, and starts a backup attempt whenever
+	//the policy's delay passes without a value, up to its max attempts. Completes with the first value, or with the last error once every
+	//attempt has failed, and cancels the handles of the attempts that lost.
+	template<typename F>
+	auto Hedge(F&& Factory, const FHedgePolicy& Policy = FHedgePolicy(), const FOptions& Options = FOptions())
+	{
+		using FutureType = std::decay_t<std::invoke_result_t<F, const FCancellationHandle&>>;
+		static_assert(Private::TIsFuture<FutureType>::Value, "The factory needs to return a TAsyncFuture.");
+		using ResultType = Private::TUnwrap_T<FutureType>;
+
+		const auto State = MakeShared<Private::THedgeState<ResultType, F>, ESPMode::ThreadSafe>(Forward<F>(Factory), Policy, Options);
+		TAsyncFuture<ResultType> Future = State->GetFuture();
+		State->Start();
+		return Future;
+	}
+}
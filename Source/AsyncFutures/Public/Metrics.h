@@ -0,0 +1,64 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+
+// Engine Includes
+#include "Async/Async.h"
+#include "CoreTypes.h"
+
+namespace UE::Tasks
+{
+	//Counts of durations in power of two buckets of microseconds, the first bucket is under 1us and the last holds everything longer
+	struct ASYNCFUTURES_API FAsyncFuturesHistogram
+	{
+		static constexpr int32 NumBuckets = 24;
+
+		uint64 Buckets[NumBuckets] = {};
+		uint64 Count = 0;
+		double TotalSeconds = 0.0;
+
+		void Add(const FAsyncFuturesHistogram& Other);
+
+		double GetAverage() const { return Count > 0 ? TotalSeconds / Count : 0.0; }
+		//Upper bound, in seconds, of the bucket the percentile (0 to 1) falls in
+		double GetPercentile(const double Percentile) const;
+
+		static int32 GetBucket(const uint64 Microseconds);
+		static double GetBucketUpperBound(const int32 Bucket);
+	};
+
+	//Totals since the module started, gathered from every thread that's used the plugin
+	struct ASYNCFUTURES_API FAsyncFuturesMetrics
+	{
+		static constexpr int32 NumExecutions = 6; //One for each EAsyncExecution
+
+		int64 LivePromises = 0;
+		uint64 PromisesCreated = 0;
+		uint64 Scheduled[NumExecutions] = {};
+		uint64 Fused = 0; //Continuations that ran straight after the stage they depend on instead of being scheduled
+		uint64 Cancellations = 0;
+		uint64 LifetimeExpired = 0;
+		FAsyncFuturesHistogram ScheduleLatency; //From being scheduled to starting
+		FAsyncFuturesHistogram RunTime;
+
+		uint64 GetScheduled(const EAsyncExecution Execution) const { return Scheduled[FMath::Clamp((int32)Execution, 0, NumExecutions - 1)]; }
+		uint64 GetTotalScheduled() const;
+
+		FString ToString() const;
+	};
+
+	namespace Private
+	{
+		//Cheap enough to always be on, each thread only touches its own counters
+		ASYNCFUTURES_API void RecordPromiseCreated();
+		ASYNCFUTURES_API void RecordPromiseDestroyed();
+		ASYNCFUTURES_API void RecordCancellation();
+		ASYNCFUTURES_API void RecordLifetimeExpired();
+		ASYNCFUTURES_API void RecordFused();
+		ASYNCFUTURES_API void RecordScheduled(const EAsyncExecution Execution);
+		ASYNCFUTURES_API void RecordStarted(const uint64 ScheduledCycles, const uint64 StartCycles);
+		ASYNCFUTURES_API void RecordFinished(const uint64 StartCycles, const uint64 EndCycles);
+
+		ASYNCFUTURES_API FAsyncFuturesMetrics GatherMetrics();
+		ASYNCFUTURES_API const TCHAR* GetExecutionName(const EAsyncExecution Execution);
+	}
+}
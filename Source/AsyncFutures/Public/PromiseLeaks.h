@@ -0,0 +1,69 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+
+// Engine Includes
+#include "Containers/Array.h"
+#include "CoreTypes.h"
+
+// Module Includes
+#include "CallSite.h"
+#include "Error.h"
+
+namespace UE::Tasks
+{
+	inline uint64 ERROR_BROKEN_PROMISE = 6;
+	class FOptions;
+
+	//Given to the futures of a started promise whose last TAsyncPromise went away without fulfilling it
+	inline FError MakeBrokenPromiseError()
+	{
+		return FError(ERROR_CONTEXT_FUTURE, ERROR_BROKEN_PROMISE, TEXT("Broken Promise"));
+	}
+
+	//Where promises were created, how many of them are still waiting on a value and how many were dropped without one
+	struct FPromiseLeakStats
+	{
+		FString File;
+		int32 Line = 0;
+		uint64 Outstanding = 0;
+		double OldestSeconds = 0.0; //Age of the oldest outstanding promise
+		uint64 Broken = 0;
+	};
+
+	//Only has the sites of promises created while they were being tracked, oldest outstanding first
+	ASYNCFUTURES_API TArray<FPromiseLeakStats> GetPromiseLeakReport();
+	//Every broken promise since the module started, tracked or not
+	ASYNCFUTURES_API uint64 GetNumBrokenPromises();
+
+	//A tracked promise that's still waiting on a value
+	struct FPendingPromise
+	{
+		uint64 Id = 0;
+		uint64 WaitingOn = 0; //The pending promise this one continues from, 0 when it isn't waiting on another tracked promise
+		FString File;
+		int32 Line = 0;
+		double AgeSeconds = 0.0;
+		FString Name; //From FOptions, empty when the work wasn't named
+		FString Target; //Where the continuation will run, empty for promises fulfilled by hand
+		FString Cancellation; //The state of the bound cancellation handle, empty when there isn't one
+	};
+
+	//Oldest first, only promises created while AsyncFutures.Promises.Track or the stall watchdog was on are known
+	ASYNCFUTURES_API TArray<FPendingPromise> GetPendingPromises(const double MinAgeSeconds = 0.0);
+	//Groups pending promises into the chains of continuations waiting on each one that's stuck
+	ASYNCFUTURES_API FString DescribePendingPromises(const double MinAgeSeconds = 0.0);
+
+	namespace Private
+	{
+		//Id to untrack the promise with, or 0 when neither AsyncFutures.Promises.Track nor the stall watchdog is on
+		ASYNCFUTURES_API uint64 TrackPromise(const FCallSite& CallSite);
+		ASYNCFUTURES_API void UntrackPromise(const uint64 TrackingId);
+		//Records what a tracked continuation is waiting on and where it will run
+		ASYNCFUTURES_API void DescribeTrackedPromise(const uint64 TrackingId, const uint64 WaitingOn, const FOptions& Options);
+		//Moves a continuation that returned a future on to waiting for that future
+		ASYNCFUTURES_API void RelinkTrackedPromise(const uint64 TrackingId, const uint64 WaitingOn);
+
+		//Reports the promise as configured by AsyncFutures.Promises.Broken. Returns true when it should be fulfilled with MakeBrokenPromiseError
+		ASYNCFUTURES_API bool ReportBrokenPromise(const uint64 TrackingId);
+	}
+}
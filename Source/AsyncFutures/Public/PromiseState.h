@@ -1,30 +1,71 @@
 // Copyright Dominic Curry. All Rights Reserved.
 #pragma once
+#include <atomic>
+
+// Engine Includes
+#include "Async/TaskGraphInterfaces.h"
+#include "Misc/ScopeLock.h"
+#include "Templates/Function.h"
 
 // Module Includes
 #include "Error.h"
 #include "FunctionTypes.h"
+#include "GraphCapture.h"
+#include "Metrics.h"
+#include "PromiseLeaks.h"
 #include "Result.h"
+#include "Trace.h"
 #include "UnwrapTypes.h"
 
 namespace UE::Tasks::Private
 {
 	template<typename T>
-	class TPromiseState 
+	class TPromiseState
 	{
+	public:
+		using FCallback = TUniqueFunction<void(const TResult<T>&)>;
+
+	private:
+		struct FCallbackNode
+		{
+			FCallback Callback;
+			FCallbackNode* Next = nullptr;
+		};
+
+		//Marks the callback list as closed once the promise has been triggered
+		static FCallbackNode* Fired() { return reinterpret_cast<FCallbackNode*>(UPTRINT(1)); }
+
 	public:
 		TPromiseState()
 			: ValueSet(false)
-			, TriggeringTask(TGraphTask<FNullGraphTask>::CreateTask().ConstructAndHold(TStatId(), ENamedThreads::GameThread))
 			, Value(TOptional<TResult<T>>())
-		{ }
+		{
+			RecordPromiseCreated();
+		}
 
 		~TPromiseState()
 		{
-			check(IsSet()); //TFutures are going out of scope and they're holding promises
-			if (FTaskGraphInterface::IsRunning() && TriggeringTask->IsCompleted() == false)
+			if (!IsSet())
 			{
-				//TriggeringTask->Unlock();
+				//Never had a TAsyncPromise to notice it was dropped, and there's nothing left to fulfil
+				if (IsStarted() && !BrokenReported.exchange(true))
+				{
+					ReportBrokenPromise(TrackingId);
+				}
+				else
+				{
+					UntrackPromise(TrackingId);
+				}
+			}
+			RecordPromiseDestroyed();
+			delete Starter.load();
+
+			FCallbackNode* Node = Callbacks.load();
+			while (Node != nullptr && Node != Fired())
+			{
+				FCallbackNode* Next = Node->Next;
+				delete Node;
+				Node = Next;
 			}
 		}
 
@@ -33,117 +74,179 @@ namespace UE::Tasks::Private
 
 		void SetValue(TResult<T>&& Result)
 		{
-			if (IsSet() == false)
+			//Only the first caller fulfils the promise, the value is written before anyone can observe it as set
+			if (Claimed.exchange(true) == false)
 			{
+				Value = MoveTemp(Result);
 				ValueSet = true;
-				if (Triggered == false)
-				{
-					Value = Result;
-					Trigger();
-				}
+				Trigger();
 			}
 		}
 
 		void SetValue(const TResult<T>& Result)
 		{
-			if (IsSet() == false)
+			if (Claimed.exchange(true) == false)
 			{
+				Value = Result;
 				ValueSet = true;
-				if (Triggered == false)
-				{
-					Value = Result;
-					Trigger();
-				}
+				Trigger();
 			}
 		}
 
-		FGraphEventRef GetCompletionEvent() const
+		//Runs the callback, with the result, on whichever thread fulfils the promise - without going through the taskgraph.
+		//Returns false, leaving the callback with the caller, when the promise has already been fulfilled.
+		bool AddCallback(FCallback&& Callback)
 		{
-			return TriggeringTask->GetCompletionEvent();
+			//Counted before it's visible so the count can never be lower than the callbacks that will run
+			++NumCallbacks;
+			FCallbackNode* Node = new FCallbackNode{ MoveTemp(Callback) };
+			FCallbackNode* Head = Callbacks.load();
+			do
+			{
+				if (Head == Fired())
+				{
+					--NumCallbacks;
+					Callback = MoveTemp(Node->Callback);
+					delete Node;
+					return false;
+				}
+				Node->Next = Head;
+			} while (!Callbacks.compare_exchange_weak(Head, Node));
+			return true;
 		}
 
-	private:
-		void Trigger()
+		//Lazy promises hold on to the work that fulfils them until they're started
+		void SetStarter(TUniqueFunction<void()>&& InStarter)
 		{
-			check(IsSet());
-			GetCompletionEvent()->DispatchSubsequents();
-			Triggered = true;
+			check(Starter.load() == nullptr);
+			Starter = new TUniqueFunction<void()>(MoveTemp(InStarter));
 		}
 
-	public:
-		std::atomic_bool ValueSet = false;
-		std::atomic_bool Triggered = false;
-		TGraphTask<FNullGraphTask>* const TriggeringTask;
-
-		TOptional<TResult<T>> Value;
-	};
-
-	template<>
-	class TPromiseState<void>
-	{
-	public:
-		TPromiseState() 
-			: ValueSet(false)
-			, TriggeringTask(TGraphTask<FNullGraphTask>::CreateTask().ConstructAndHold(TStatId(), ENamedThreads::GameThread))
-			, Value(TOptional<TResult<void>>())
-		{}
-
-		~TPromiseState() 
+		void Start()
 		{
-			check(IsSet()); //TFutures are going out of scope and they're holding promises
-			if (FTaskGraphInterface::IsRunning() && TriggeringTask->IsCompleted() == false)
+			if (Starter.load() != nullptr)
 			{
-				//TriggeringTask->Unlock();
+				if (TUniqueFunction<void()>* Pending = Starter.exchange(nullptr))
+				{
+					(*Pending)();
+					delete Pending;
+				}
 			}
-		} 
+		}
 
-		bool IsSet() const { return ValueSet; }
-		TResult<void> Get() const { check(IsSet() && Value.IsSet()); return Value.GetValue(); }
+		bool IsStarted() const { return Starter.load() == nullptr; }
 
-		void SetValue(TResult<void>&& Result)
+		//Counts the TAsyncPromises that can still fulfil this state. Losing the last one leaves its futures waiting forever
+		void AddPromise() { ++NumPromises; }
+		void ReleasePromise()
 		{
-			if (IsSet() == false)
+			//A lazy promise that hasn't started yet gets a new TAsyncPromise when it does
+			if (--NumPromises == 0 && !IsSet() && IsStarted() && !BrokenReported.exchange(true))
 			{
-				ValueSet = true;
-				if (Triggered == false)
+				if (ReportBrokenPromise(TrackingId))
 				{
-					Value = Result;
-					Trigger();
+					SetValue(TResult<T>(MakeBrokenPromiseError()));
 				}
 			}
 		}
 
-		void SetValue(const TResult<void>& Result)
+		//Records where the promise was created when AsyncFutures.Promises.Track is on. Called before the state is shared
+		void Track(const FCallSite& CallSite)
 		{
-			if (IsSet() == false)
+			TrackingId = TrackPromise(CallSite);
+			if (const uint64 NodeId = CaptureId.load())
 			{
-				ValueSet = true;
-				if (Triggered == false)
-				{
-					Value = Result;
-					Trigger();
-				}
+				CaptureCallSite(NodeId, CallSite);
 			}
 		}
+		uint64 GetTrackingId() const { return TrackingId; }
+
+		//Never lower than the number of callbacks that will run, and exact once the promise has been fulfilled and no one else is adding
+		int32 GetNumCallbacks() const { return NumCallbacks; }
 
+		//Only created for those who need to wait on the promise through the taskgraph
 		FGraphEventRef GetCompletionEvent() const
 		{
-			return TriggeringTask->GetCompletionEvent();
+			FScopeLock Lock(&EventCriticalSection);
+			if (!CompletionEvent.IsValid())
+			{
+				CompletionEvent = FGraphEvent::CreateGraphEvent();
+				if (Triggered)
+				{
+					CompletionEvent->DispatchSubsequents();
+				}
+			}
+			return CompletionEvent;
 		}
 
 	private:
-		void Trigger() 
-		{ 
+		void Trigger()
+		{
 			check(IsSet());
-			GetCompletionEvent()->DispatchSubsequents();
-			Triggered = true;
+			TracePromiseFulfilled(TraceId, Value.GetValue().HasError());
+			UntrackPromise(TrackingId);
+			if (const uint64 NodeId = CaptureId.load())
+			{
+				CapturePromiseFulfilled(NodeId, Value.GetValue().HasError());
+			}
+			if (Value.GetValue().IsCancelled())
+			{
+				RecordCancellation();
+			}
+
+			FGraphEventRef Event;
+			{
+				FScopeLock Lock(&EventCriticalSection);
+				Triggered = true;
+				Event = CompletionEvent;
+			}
+			if (Event.IsValid())
+			{
+				Event->DispatchSubsequents();
+			}
+
+			//Close the list to new callbacks and run the registered ones in the order they were added
+			FCallbackNode* Node = Callbacks.exchange(Fired());
+			FCallbackNode* Ordered = nullptr;
+			while (Node != nullptr)
+			{
+				FCallbackNode* Next = Node->Next;
+				Node->Next = Ordered;
+				Ordered = Node;
+				Node = Next;
+			}
+
+			const TResult<T>& Result = Value.GetValue();
+			while (Ordered != nullptr)
+			{
+				FCallbackNode* Next = Ordered->Next;
+				Ordered->Callback(Result);
+				delete Ordered;
+				Ordered = Next;
+			}
 		}
 
 	public:
 		std::atomic_bool ValueSet = false;
 		std::atomic_bool Triggered = false;
-		TGraphTask<FNullGraphTask>* const TriggeringTask;
+		std::atomic_bool Claimed = false;
 
-		TOptional<TResult<void>> Value;
+		TOptional<TResult<T>> Value;
+
+		//Identifies the promise in the AsyncFutures trace channel, 0 when it wasn't traced
+		const uint64 TraceId = TracePromiseCreated();
+		//Node in the running graph capture, 0 when the promise isn't being captured
+		std::atomic<uint64> CaptureId = CapturePromiseCreated();
+
+	private:
+		std::atomic<FCallbackNode*> Callbacks = nullptr;
+		std::atomic<int32> NumCallbacks = 0;
+		std::atomic<TUniqueFunction<void()>*> Starter = nullptr;
+		std::atomic<int32> NumPromises = 0;
+		std::atomic_bool BrokenReported = false;
+		uint64 TrackingId = 0;
+
+		mutable FCriticalSection EventCriticalSection;
+		mutable FGraphEventRef CompletionEvent;
 	};
 }
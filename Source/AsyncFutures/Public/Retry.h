@@ -0,0 +1,174 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+#include <atomic>
+#include <type_traits>
+
+// Module Includes
+#include "AsyncFuture.h"
+#include "AsyncFutureHelpers.h"
+#include "Timer.h"
+
+namespace UE::Tasks
+{
+	//How often and how far apart Retry calls the factory again. Delays grow exponentially from the initial delay up to the max delay,
+	//and a random fraction of each one up to the jitter is taken off so callers failing together don't retry together.
+	struct FRetryPolicy
+	{
+	public:
+		int32 MaxAttempts = 3;
+		double InitialDelay = 0.1;
+		double MaxDelay = 10.0;
+		double Multiplier = 2.0;
+		double Jitter = 0.5;
+		double Deadline = 0.0; //Seconds from the first attempt, zero or less for none
+
+		//Without any filters every error except cancellation is retried
+		FRetryPolicy& RetryOn(const uint64 Context) { Filters.Add(FFilter{ Context, TOptional<uint64>() }); return *this; }
+		FRetryPolicy& RetryOn(const uint64 Context, const uint64 Code) { Filters.Add(FFilter{ Context, Code }); return *this; }
+		FRetryPolicy& RetryIf(TFunction<bool(const FError&)> InPredicate) { Predicate = MoveTemp(InPredicate); return *this; }
+
+		bool IsRetryable(const FError& Error) const
+		{
+			if (Error == MakeCancelledError())
+			{
+				return false;
+			}
+			if (Filters.Num() == 0 && !Predicate)
+			{
+				return true;
+			}
+			for (const FFilter& Filter : Filters)
+			{
+				if (Filter.Context == Error.GetContext() && (!Filter.Code.IsSet() || Filter.Code.GetValue() == Error.GetCode()))
+				{
+					return true;
+				}
+			}
+			return Predicate && Predicate(Error);
+		}
+
+		//Delay before the next attempt, after the given number have failed
+		double GetDelay(const int32 FailedAttempts) const
+		{
+			const double Backoff = FMath::Min(MaxDelay, InitialDelay * FMath::Pow(Multiplier, (double)FMath::Max(FailedAttempts - 1, 0)));
+			return Backoff * (1.0 - FMath::Clamp(Jitter, 0.0, 1.0) * FMath::FRand());
+		}
+
+	private:
+		struct FFilter
+		{
+			uint64 Context;
+			TOptional<uint64> Code;
+		};
+
+		TArray<FFilter> Filters;
+		TFunction<bool(const FError&)> Predicate;
+	};
+
+	namespace Private
+	{
+		template<typename T, typename F>
+		class TRetryState : public TSharedFromThis<TRetryState<T, F>, ESPMode::ThreadSafe>
+		{
+		public:
+			TRetryState(F&& InFactory, const FRetryPolicy& InPolicy, const FOptions& InOptions)
+				: Factory(Forward<F>(InFactory))
+				, Policy(InPolicy)
+				, Options(InOptions)
+				, StartTime(FPlatformTime::Seconds())
+			{
+				const TOptional<FCancellationHandle>& Cancellation = Options.GetCancellation();
+				if (Cancellation.IsSet())
+				{
+					FCancellationHandle Handle = Cancellation.GetValue();
+					Handle.Bind(Promise);
+				}
+			}
+
+			TAsyncFuture<T> GetFuture() { return Promise.GetFuture(); }
+
+			void Launch()
+			{
+				Dispatch(Options, [State = this->AsShared()]() { State->RunAttempt(); });
+			}
+
+		private:
+			void RunAttempt()
+			{
+				//Cancelled while waiting for its turn
+				if (Promise.IsSet())
+				{
+					return;
+				}
+
+				++Attempts;
+				TAsyncFuture<T> Future = Factory();
+				const TSharedRef<TPromiseState<T>, ESPMode::ThreadSafe> FutureState = FFutureAccess::GetState(Future);
+				typename TPromiseState<T>::FCallback OnCompleted = [State = this->AsShared()](const TResult<T>& Result)
+				{
+					State->AttemptCompleted(Result);
+				};
+				if (!FutureState->AddCallback(MoveTemp(OnCompleted)))
+				{
+					OnCompleted(FutureState->Get());
+				}
+				FutureState->Start();
+			}
+
+			void AttemptCompleted(const TResult<T>& Result)
+			{
+				if (Result.HasError() && ShouldRetry(Result.GetError()))
+				{
+					const double Delay = Policy.GetDelay(Attempts);
+					if (Policy.Deadline <= 0.0 || FPlatformTime::Seconds() + Delay < StartTime + Policy.Deadline)
+					{
+						//Waits on the shared timer rather than holding a thread or a ticker of its own
+						const TAsyncPromise<void> Timer;
+						typename TPromiseState<void>::FCallback OnElapsed = [State = this->AsShared()](const TResult<void>&)
+						{
+							State->Launch();
+						};
+						if (!Timer.State->AddCallback(MoveTemp(OnElapsed)))
+						{
+							OnElapsed(Timer.Get());
+						}
+						StartTimer(Delay, Timer);
+						return;
+					}
+				}
+
+				Promise.SetValue(Result);
+			}
+
+			bool ShouldRetry(const FError& Error) const
+			{
+				const TOptional<FCancellationHandle>& Cancellation = Options.GetCancellation();
+				const bool bCancelled = Promise.IsSet() || (Cancellation.IsSet() && Cancellation.GetValue().IsCancelled());
+				return !bCancelled && Attempts < Policy.MaxAttempts && Policy.IsRetryable(Error);
+			}
+
+			std::remove_cv_t<typename TRemoveReference<F>::Type> Factory;
+			const FRetryPolicy Policy;
+			const FOptions Options;
+			const double StartTime;
+			std::atomic<int32> Attempts = 0;
+			TAsyncPromise<T> Promise;
+		};
+	}
+
+	//Calls the factory, which returns a TAsyncFuture, and calls it again after a backoff while its result is a retryable error.
+	//Completes with the first value, or the last error once the policy's attempts or deadline are used up. Attempts are dispatched
+	//with the options, and cancelling their handle completes the retry as cancelled and stops any further attempts.
+	template<typename F>
+	auto Retry(F&& Factory, const FRetryPolicy& Policy = FRetryPolicy(), const FOptions& Options = FOptions())
+	{
+		using FutureType = std::decay_t<std::invoke_result_t<F>>;
+		static_assert(Private::TIsFuture<FutureType>::Value, "The factory needs to return a TAsyncFuture.");
+		using ResultType = Private::TUnwrap_T<FutureType>;
+
+		const auto State = MakeShared<Private::TRetryState<ResultType, F>, ESPMode::ThreadSafe>(Forward<F>(Factory), Policy, Options);
+		TAsyncFuture<ResultType> Future = State->GetFuture();
+		State->Launch();
+		return Future;
+	}
+}
@@ -0,0 +1,72 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+
+// Engine Includes
+#include "Async/Async.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "CoreTypes.h"
+#include "Misc/Optional.h"
+#include "Templates/Function.h"
+
+namespace UE::Tasks
+{
+	class FOptions;
+
+	//Relative importance of a task. Mapped onto the taskgraph/thread pool priorities, and ordered by the plugin's own queues
+	enum class EAsyncPriority : uint8
+	{
+		Critical,
+		High,
+		Normal,
+		Background
+	};
+
+	//What runs work for EAsyncExecution::TaskGraph, selected with AsyncFutures.Backend
+	enum class EAsyncBackend : uint8
+	{
+		TaskGraph, //FFunctionGraphTask
+		Tasks //UE::Tasks::Launch, lighter to allocate. Named threads still get graph tasks
+	};
+
+	namespace Private
+	{
+		ASYNCFUTURES_API EAsyncBackend GetBackend();
+
+		//Schedules a unit of work on whatever thread, execution and priority the options describe
+		ASYNCFUTURES_API void Dispatch(const FOptions& Options, TUniqueFunction<void()>&& Work);
+
+		//Lets the threads kept for EAsyncExecution::Thread work exit, later work gets a thread of its own
+		ASYNCFUTURES_API void StopDedicatedThreads();
+
+		//How many units of work the options' execution can usefully run at once
+		ASYNCFUTURES_API int32 GetConcurrency(const FOptions& Options);
+
+		struct FExecutionContext
+		{
+			EAsyncExecution Execution;
+			ENamedThreads::Type Thread;
+			TOptional<EAsyncPriority> Priority;
+			int32 Depth;
+			const void* Fulfilling; //The promise state the running stage fulfils
+		};
+
+		//Marks the calling thread as running the stage that fulfils the promise state, with the options, while in scope
+		class ASYNCFUTURES_API FExecutionScope
+		{
+		public:
+			FExecutionScope(const FOptions& Options, const void* Fulfilling);
+			~FExecutionScope();
+
+			FExecutionScope(const FExecutionScope&) = delete;
+			FExecutionScope& operator=(const FExecutionScope&) = delete;
+
+		private:
+			FExecutionContext Context;
+			const FExecutionContext* Previous;
+		};
+
+		//Whether work for the options, waiting on the promise state, can run straight away on the calling thread. Only when the thread is
+		//running the stage that fulfils that promise on the same executor, not when a stage fulfils some other promise along the way
+		ASYNCFUTURES_API bool CanRunInline(const FOptions& Options, const void* Fulfilled);
+	}
+}
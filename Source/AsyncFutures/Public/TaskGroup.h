@@ -0,0 +1,158 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+#include <atomic>
+
+// Engine Includes
+#include "Containers/SparseArray.h"
+#include "Misc/ScopeLock.h"
+
+// Module Includes
+#include "AsyncFuture.h"
+#include "AsyncFutureHelpers.h"
+
+namespace UE::Tasks
+{
+	namespace Private
+	{
+		class FTaskGroupState : public TSharedFromThis<FTaskGroupState, ESPMode::ThreadSafe>
+		{
+		public:
+			template<typename T>
+			void Add(const TAsyncFuture<T>& Future)
+			{
+				const TSharedRef<TPromiseState<T>, ESPMode::ThreadSafe> Child = FFutureAccess::GetState(Future);
+				++Outstanding;
+
+				int32 Index = INDEX_NONE;
+				{
+					FScopeLock Lock(&CriticalSection);
+					if (!Cancelled)
+					{
+						Index = Children.Add(MakeShared<TBoundPromise<T>, ESPMode::ThreadSafe>(Child));
+					}
+				}
+
+				if (Index == INDEX_NONE)
+				{
+					Child->SetValue(TResult<T>(MakeCancelledError()));
+				}
+
+				//Children report straight back to the group when they're fulfilled rather than through a continuation each
+				typename TPromiseState<T>::FCallback OnCompleted = [State = AsShared(), Index](const TResult<T>& Result)
+				{
+					State->ChildCompleted(Index, Result.HasError() ? &Result.GetError() : nullptr);
+				};
+				if (!Child->AddCallback(MoveTemp(OnCompleted)))
+				{
+					OnCompleted(Child->Get());
+				}
+				Child->Start();
+			}
+
+			TAsyncFuture<void> Join()
+			{
+				//The group holds one count of its own until it's joined, so it can't complete while children are still being added
+				if (!Joined.exchange(true))
+				{
+					Release();
+				}
+				return JoinPromise.GetFuture();
+			}
+
+			void Cancel()
+			{
+				TArray<TSharedRef<IBoundPromise, ESPMode::ThreadSafe>> ToCancel;
+				{
+					FScopeLock Lock(&CriticalSection);
+					Cancelled = true;
+					for (const TSharedRef<IBoundPromise, ESPMode::ThreadSafe>& Child : Children)
+					{
+						ToCancel.Add(Child);
+					}
+				}
+
+				//Cancelling completes the children, which takes the lock again
+				for (const TSharedRef<IBoundPromise, ESPMode::ThreadSafe>& Child : ToCancel)
+				{
+					Child->Cancel();
+				}
+			}
+
+		private:
+			void ChildCompleted(const int32 Index, const FError* Error)
+			{
+				{
+					FScopeLock Lock(&CriticalSection);
+					if (Index != INDEX_NONE)
+					{
+						Children.RemoveAt(Index);
+					}
+					if (Error != nullptr && !FirstError.IsSet())
+					{
+						FirstError = *Error;
+					}
+				}
+				Release();
+			}
+
+			void Release()
+			{
+				if (--Outstanding == 0)
+				{
+					if (FirstError.IsSet())
+					{
+						JoinPromise.SetValue(FirstError.GetValue());
+					}
+					else
+					{
+						JoinPromise.SetValue();
+					}
+				}
+			}
+
+			std::atomic<int32> Outstanding = 1;
+			std::atomic_bool Joined = false;
+			TAsyncPromise<void> JoinPromise;
+
+			FCriticalSection CriticalSection;
+			bool Cancelled = false;
+			TSparseArray<TSharedRef<IBoundPromise, ESPMode::ThreadSafe>> Children;
+			TOptional<FError> FirstError;
+		};
+	}
+
+	//Scope that owns every future launched through or added to it. Join completes once all of them have, with the first error if any failed,
+	//and destroying the group cancels whatever is still outstanding so no work outlives the system that started it.
+	class FTaskGroup
+	{
+	public:
+		FTaskGroup() : State(MakeShared<Private::FTaskGroupState, ESPMode::ThreadSafe>()) {}
+		~FTaskGroup()
+		{
+			State->Cancel();
+			State->Join();
+		}
+
+		FTaskGroup(const FTaskGroup& Other) = delete;
+		FTaskGroup& operator=(const FTaskGroup& Other) = delete;
+
+		//Runs the function as Async would, as a child of the group
+		template<typename F>
+		auto Launch(F&& Function, const FOptions& Options = FOptions())
+		{
+			auto Future = Async(Forward<F>(Function), Options);
+			State->Add(Future);
+			return Future;
+		}
+
+		template<typename T>
+		void Add(const TAsyncFuture<T>& Future) { State->Add(Future); }
+
+		//Children need to be added before the join completes to be waited on
+		TAsyncFuture<void> Join() { return State->Join(); }
+		void Cancel() { State->Cancel(); }
+
+	private:
+		TSharedRef<Private::FTaskGroupState, ESPMode::ThreadSafe> State;
+	};
+}
@@ -0,0 +1,11 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+
+// Module Includes
+#include "AsyncFuture.h"
+
+namespace UE::Tasks::Private
+{
+	//Completes the promise once the delay has passed. Every timer shares one core ticker registration, ordered by deadline
+	ASYNCFUTURES_API void StartTimer(const double DelayInSeconds, const TAsyncPromise<void>& Promise);
+}
@@ -0,0 +1,62 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+
+// Engine Includes
+#include "CoreTypes.h"
+#include "Stats/Stats.h"
+#include "Trace/Config.h"
+#include "Trace/Trace.h"
+
+#if !defined(ASYNCFUTURES_TRACE_ENABLED)
+#define ASYNCFUTURES_TRACE_ENABLED (UE_TRACE_ENABLED && !UE_BUILD_SHIPPING)
+#endif
+
+#if ASYNCFUTURES_TRACE_ENABLED
+//Enable with -trace=asyncfutures, or Trace.Enable AsyncFutures
+UE_TRACE_CHANNEL_EXTERN(AsyncFuturesChannel, ASYNCFUTURES_API)
+#endif
+
+namespace UE::Tasks::Private
+{
+#if ASYNCFUTURES_TRACE_ENABLED
+	//Returns the id later events for the promise refer to, or 0 when the channel is off and the promise isn't traced
+	ASYNCFUTURES_API uint64 TracePromiseCreated();
+	ASYNCFUTURES_API void TracePromiseFulfilled(const uint64 PromiseId, const bool bError);
+	//Links a continuation's promise to the promise it's waiting on
+	ASYNCFUTURES_API void TraceContinuationScheduled(const uint64 AntecedentId, const uint64 PromiseId, const TCHAR* Name);
+	//Returns whether a named span was opened, which the end closes
+	ASYNCFUTURES_API bool TraceContinuationStarted(const uint64 PromiseId, const TCHAR* Name);
+	ASYNCFUTURES_API void TraceContinuationEnded(const uint64 PromiseId, const bool bNamedSpan);
+#else
+	inline uint64 TracePromiseCreated() { return 0; }
+	inline void TracePromiseFulfilled(const uint64 PromiseId, const bool bError) {}
+	inline void TraceContinuationScheduled(const uint64 AntecedentId, const uint64 PromiseId, const TCHAR* Name) {}
+	inline bool TraceContinuationStarted(const uint64 PromiseId, const TCHAR* Name) { return false; }
+	inline void TraceContinuationEnded(const uint64 PromiseId, const bool bNamedSpan) {}
+#endif
+
+	//Brackets a continuation running, as a named span in Insights when it has a name and under its stat when it has one
+	class FTraceContinuationScope
+	{
+	public:
+		FTraceContinuationScope(const uint64 InPromiseId, const TCHAR* InName, const TStatId StatId)
+			: CycleCounter(StatId)
+			, PromiseId(InPromiseId)
+			, bNamedSpan(TraceContinuationStarted(InPromiseId, InName))
+		{
+		}
+
+		~FTraceContinuationScope()
+		{
+			TraceContinuationEnded(PromiseId, bNamedSpan);
+		}
+
+		FTraceContinuationScope(const FTraceContinuationScope&) = delete;
+		FTraceContinuationScope& operator=(const FTraceContinuationScope&) = delete;
+
+	private:
+		FScopeCycleCounter CycleCounter;
+		const uint64 PromiseId;
+		const bool bNamedSpan;
+	};
+}
@@ -0,0 +1,21 @@
+// Copyright Dominic Curry. All Rights Reserved.
+using UnrealBuildTool;
+
+public class AsyncFutureBenchmarks : ModuleRules
+{
+	public AsyncFutureBenchmarks(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new string[] {
+			"AsyncFutures",
+			"Core",
+		});
+
+		PrivateDependencyModuleNames.AddRange(new string[] {
+			"CoreUObject",
+			"Engine",
+			"Json",
+		});
+	}
+}
@@ -0,0 +1,41 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include "AsyncFuturesBenchmarkCommandlet.h"
+
+// Engine Includes
+#include "Misc/DateTime.h"
+#include "Misc/Parse.h"
+
+// Module Includes
+#include "BenchmarkModule.h"
+#include "Benchmarks.h"
+
+UAsyncFuturesBenchmarkCommandlet::UAsyncFuturesBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UAsyncFuturesBenchmarkCommandlet::Main(const FString& Params)
+{
+	UE::Tasks::Benchmark::FBenchmarkSettings Settings;
+	FParse::Value(*Params, TEXT("Samples="), Settings.Samples);
+	FParse::Value(*Params, TEXT("Scale="), Settings.Scale);
+	FParse::Value(*Params, TEXT("Filter="), Settings.Filter);
+
+	FString Output = UE::Tasks::Benchmark::GetDefaultOutputDirectory();
+	FParse::Value(*Params, TEXT("Output="), Output);
+	FString BaseName = FString::Printf(TEXT("Benchmark-%s"), *FDateTime::Now().ToString());
+	FParse::Value(*Params, TEXT("Name="), BaseName);
+
+	const TArray<UE::Tasks::Benchmark::FBenchmarkResult> Results = UE::Tasks::Benchmark::RunBenchmarks(Settings);
+	if (!UE::Tasks::Benchmark::WriteResults(Results, Output, BaseName))
+	{
+		UE_LOG(LogAsyncFutureBenchmarks, Error, TEXT("Couldn't write benchmark results to %s"), *Output);
+		return 1;
+	}
+
+	UE_LOG(LogAsyncFutureBenchmarks, Display, TEXT("Wrote %d benchmark results to %s/%s.json and .csv"), Results.Num(), *Output, *BaseName);
+	return 0;
+}
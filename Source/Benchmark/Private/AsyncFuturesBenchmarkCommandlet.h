@@ -0,0 +1,22 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+
+// Engine Includes
+#include "Commandlets/Commandlet.h"
+
+#include "AsyncFuturesBenchmarkCommandlet.generated.h"
+
+/**
+ * Runs the futures benchmarks headless and writes the results as JSON and CSV.
+ * -run=AsyncFuturesBenchmark [-Samples=10] [-Scale=1.0] [-Filter=Name] [-Output=Directory] [-Name=BaseName]
+ */
+UCLASS()
+class UAsyncFuturesBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAsyncFuturesBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
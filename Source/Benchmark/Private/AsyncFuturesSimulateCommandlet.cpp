@@ -0,0 +1,83 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include "AsyncFuturesSimulateCommandlet.h"
+
+// Engine Includes
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+// Module Includes
+#include "BenchmarkModule.h"
+#include "Simulator.h"
+
+UAsyncFuturesSimulateCommandlet::UAsyncFuturesSimulateCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UAsyncFuturesSimulateCommandlet::Main(const FString& Params)
+{
+	using namespace UE::Tasks::Benchmark;
+
+	FString GraphPath;
+	if (!FParse::Value(*Params, TEXT("Graph="), GraphPath))
+	{
+		UE_LOG(LogAsyncFutureBenchmarks, Error, TEXT("Needs -Graph= with the path to a graph written by AsyncFutures.Graph.End"));
+		return 1;
+	}
+
+	UE::Tasks::FFutureGraph Graph;
+	if (!LoadGraph(GraphPath, Graph))
+	{
+		UE_LOG(LogAsyncFutureBenchmarks, Error, TEXT("Couldn't read a graph from %s"), *GraphPath);
+		return 1;
+	}
+
+	FString WorkersList = TEXT("1,2,4,8,16,32");
+	FParse::Value(*Params, TEXT("Workers="), WorkersList);
+	TArray<FString> Values;
+	WorkersList.ParseIntoArray(Values, TEXT(","));
+	TArray<int32> Workers;
+	for (const FString& Value : Values)
+	{
+		Workers.Add(FMath::Max(FCString::Atoi(*Value), 1));
+	}
+
+	FString PolicyList = TEXT("Fifo,Lifo,CriticalPath");
+	FParse::Value(*Params, TEXT("Policy="), PolicyList);
+	PolicyList.ParseIntoArray(Values, TEXT(","));
+	TArray<ESimulatedPolicy> Policies;
+	for (const ESimulatedPolicy Policy : { ESimulatedPolicy::Fifo, ESimulatedPolicy::Lifo, ESimulatedPolicy::CriticalPath })
+	{
+		if (Values.Contains(GetPolicyName(Policy)))
+		{
+			Policies.Add(Policy);
+		}
+	}
+
+	FSimulationSettings Settings;
+	FParse::Value(*Params, TEXT("DispatchMs="), Settings.DispatchMs);
+	Settings.bPinNamedThreads = !FParse::Param(*Params, TEXT("Unpinned"));
+
+	const TArray<FSimulationResult> Results = SimulateGraph(Graph, Workers, Policies, Settings);
+	UE_LOG(LogAsyncFutureBenchmarks, Display, TEXT("%d promises, %.2fms when captured"), Graph.Nodes.Num(), Graph.DurationMs);
+	for (const FSimulationResult& Result : Results)
+	{
+		UE_LOG(LogAsyncFutureBenchmarks, Display, TEXT("%-12s %3d workers: %.2fms (critical path %.2fms, %.0f%% utilized)"),
+			GetPolicyName(Result.Policy), Result.Workers, Result.MakespanMs, Result.CriticalPathMs, Result.Utilization * 100.0);
+	}
+
+	FString Output = FPaths::ChangeExtension(GraphPath, TEXT("")) + TEXT("-Simulated.csv");
+	FParse::Value(*Params, TEXT("Output="), Output);
+	if (!FFileHelper::SaveStringToFile(ToCsv(Results), *Output))
+	{
+		UE_LOG(LogAsyncFutureBenchmarks, Error, TEXT("Couldn't write simulation results to %s"), *Output);
+		return 1;
+	}
+
+	UE_LOG(LogAsyncFutureBenchmarks, Display, TEXT("Wrote %d simulation results to %s"), Results.Num(), *Output);
+	return 0;
+}
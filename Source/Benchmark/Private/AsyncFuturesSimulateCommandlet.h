@@ -0,0 +1,22 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+
+// Engine Includes
+#include "Commandlets/Commandlet.h"
+
+#include "AsyncFuturesSimulateCommandlet.generated.h"
+
+/**
+ * Replays a graph written by AsyncFutures.Graph.End on a range of worker counts and scheduling policies, and writes the makespans as CSV.
+ * -run=AsyncFuturesSimulate -Graph=Path.json [-Workers=1,2,4,8,16,32] [-Policy=Fifo,Lifo,CriticalPath] [-DispatchMs=0.0] [-Unpinned] [-Output=Path.csv]
+ */
+UCLASS()
+class UAsyncFuturesSimulateCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UAsyncFuturesSimulateCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
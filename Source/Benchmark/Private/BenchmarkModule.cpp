@@ -0,0 +1,11 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include "BenchmarkModule.h"
+
+DEFINE_LOG_CATEGORY(LogAsyncFutureBenchmarks);
+
+class FAsyncFutureBenchmarks : public IAsyncFutureBenchmarks
+{
+
+};
+
+IMPLEMENT_MODULE(FAsyncFutureBenchmarks, AsyncFutureBenchmarks)
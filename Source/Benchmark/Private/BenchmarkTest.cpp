@@ -0,0 +1,25 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include <CoreMinimal.h>
+#include <Misc/AutomationTest.h>
+#include <Misc/DateTime.h>
+
+#include "Benchmarks.h"
+
+//Perf filter so it only runs when asked for, writes the same files as the commandlet
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAsyncFuturesBenchmarkTest, "AsyncFutures.Benchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext | EAutomationTestFlags::PerfFilter)
+
+bool FAsyncFuturesBenchmarkTest::RunTest(const FString& Parameters)
+{
+	UE::Tasks::Benchmark::FBenchmarkSettings Settings;
+	Settings.Samples = 5;
+
+	const TArray<UE::Tasks::Benchmark::FBenchmarkResult> Results = UE::Tasks::Benchmark::RunBenchmarks(Settings);
+	for (const UE::Tasks::Benchmark::FBenchmarkResult& Result : Results)
+	{
+		AddInfo(FString::Printf(TEXT("%s [%s] size %d: %.0f ops/s, p50 %.1fus"), *Result.Name, *Result.Variant, Result.Size, Result.OperationsPerSecond, Result.P50Microseconds));
+	}
+
+	const FString BaseName = FString::Printf(TEXT("Automation-%s"), *FDateTime::Now().ToString());
+	TestTrue("Results were written", UE::Tasks::Benchmark::WriteResults(Results, UE::Tasks::Benchmark::GetDefaultOutputDirectory(), BaseName));
+	return true;
+}
@@ -0,0 +1,359 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include "Benchmarks.h"
+
+// Engine Includes
+#include "Async/Async.h"
+#include "Async/Future.h"
+#include "Dom/JsonObject.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMisc.h"
+#include "HAL/PlatformProperties.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Tasks/Task.h"
+
+// Module Includes
+#include "AsyncFutures.h"
+#include "BenchmarkModule.h"
+
+namespace UE::Tasks::Benchmark
+{
+	namespace Private
+	{
+		template<typename T>
+		static void WaitFor(const TAsyncFuture<T>& Future)
+		{
+			if (!Future.IsReady())
+			{
+				FTaskGraphInterface::Get().WaitUntilTaskCompletes(UE::Tasks::Private::FFutureAccess::GetState(Future)->GetCompletionEvent());
+			}
+		}
+
+		static double Time(TFunctionRef<void()> Work)
+		{
+			const uint64 Start = FPlatformTime::Cycles64();
+			Work();
+			return FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - Start);
+		}
+
+		static int32 Scale(const FBenchmarkSettings& Settings, const int32 Count)
+		{
+			return FMath::Max(1, FMath::RoundToInt(Count * Settings.Scale));
+		}
+
+		//Runs the sample once to warm up and then once per timed sample. Each run returns how long its timed part took
+		static void Run(TArray<FBenchmarkResult>& Results, const FBenchmarkSettings& Settings, const TCHAR* Name, const TCHAR* Variant, const int32 Size, const int32 Operations, TFunctionRef<double()> Sample)
+		{
+			if (!Settings.Filter.IsEmpty() && !FString(Name).Contains(Settings.Filter))
+			{
+				return;
+			}
+
+			Sample();
+			TArray<double> Durations;
+			for (int32 Index = 0; Index < FMath::Max(Settings.Samples, 1); ++Index)
+			{
+				Durations.Add(Sample());
+			}
+			Durations.Sort();
+
+			double Total = 0.0;
+			for (const double Duration : Durations)
+			{
+				Total += Duration;
+			}
+
+			FBenchmarkResult& Result = Results.AddDefaulted_GetRef();
+			Result.Name = Name;
+			Result.Variant = Variant;
+			Result.Size = Size;
+			Result.Operations = Operations;
+			Result.Samples = Durations.Num();
+			Result.OperationsPerSecond = Total > 0.0 ? ((double)Operations * Durations.Num()) / Total : 0.0;
+			Result.MeanMicroseconds = Total / Durations.Num() * 1000000.0;
+			Result.MinMicroseconds = Durations[0] * 1000000.0;
+			Result.P50Microseconds = Durations[(Durations.Num() - 1) / 2] * 1000000.0;
+			Result.P99Microseconds = Durations[FMath::Min(FMath::CeilToInt(Durations.Num() * 0.99) - 1, Durations.Num() - 1)] * 1000000.0;
+
+			UE_LOG(LogAsyncFutureBenchmarks, Display, TEXT("%s [%s] size %d: %.0f ops/s, p50 %.1fus, p99 %.1fus"), Name, Variant, Size, Result.OperationsPerSecond, Result.P50Microseconds, Result.P99Microseconds);
+		}
+
+		static TAsyncFuture<void> LaunchAll(const int32 Count, const FOptions& Options)
+		{
+			TArray<TAsyncFuture<void>> Futures;
+			Futures.Reserve(Count);
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				Futures.Add(Async([]() {}, Options));
+			}
+			return WhenAll(Futures);
+		}
+
+		static void RunLaunchBenchmarks(TArray<FBenchmarkResult>& Results, const FBenchmarkSettings& Settings)
+		{
+			const int32 Count = Scale(Settings, 1000);
+			Run(Results, Settings, TEXT("Async.Launch"), TEXT("AsyncFutures"), Count, Count, [Count]()
+			{
+				return Time([Count]() { WaitFor(LaunchAll(Count, FOptions())); });
+			});
+
+			Run(Results, Settings, TEXT("Async.Launch"), TEXT("TFuture"), Count, Count, [Count]()
+			{
+				return Time([Count]()
+				{
+					TArray<TFuture<void>> Futures;
+					Futures.Reserve(Count);
+					for (int32 Index = 0; Index < Count; ++Index)
+					{
+						Futures.Add(::Async(EAsyncExecution::TaskGraph, []() {}));
+					}
+					for (const TFuture<void>& Future : Futures)
+					{
+						Future.Wait();
+					}
+				});
+			});
+
+			Run(Results, Settings, TEXT("Async.Launch"), TEXT("UE::Tasks::Launch"), Count, Count, [Count]()
+			{
+				return Time([Count]()
+				{
+					TArray<UE::Tasks::FTask> Tasks;
+					Tasks.Reserve(Count);
+					for (int32 Index = 0; Index < Count; ++Index)
+					{
+						Tasks.Add(UE::Tasks::Launch(UE_SOURCE_LOCATION, []() {}));
+					}
+					UE::Tasks::Wait(Tasks);
+				});
+			});
+		}
+
+		static void RunChainBenchmarks(TArray<FBenchmarkResult>& Results, const FBenchmarkSettings& Settings)
+		{
+			//Latency from the first promise being fulfilled to the end of the chain, the chain is built before timing
+			for (const int32 Depth : { 1, 16, 128 })
+			{
+				Run(Results, Settings, TEXT("Then.ChainLatency"), TEXT("AsyncFutures"), Depth, Depth, [Depth]()
+				{
+					TAsyncPromise<void> Promise;
+					TAsyncFuture<void> Future = Promise.GetFuture();
+					for (int32 Index = 0; Index < Depth; ++Index)
+					{
+						Future = Future.Then([]() {});
+					}
+					return Time([&Promise, &Future]()
+					{
+						Promise.SetValue();
+						WaitFor(Future);
+					});
+				});
+
+				Run(Results, Settings, TEXT("Then.ChainLatency"), TEXT("TFuture"), Depth, Depth, [Depth]()
+				{
+					TPromise<void> Promise;
+					TFuture<void> Future = Promise.GetFuture();
+					for (int32 Index = 0; Index < Depth; ++Index)
+					{
+						Future = Future.Then([](TFuture<void>) {});
+					}
+					return Time([&Promise, &Future]()
+					{
+						Promise.SetValue();
+						Future.Wait();
+					});
+				});
+			}
+		}
+
+		static void RunCombinationBenchmarks(TArray<FBenchmarkResult>& Results, const FBenchmarkSettings& Settings)
+		{
+			for (const int32 Count : { 10, 100, 1000 })
+			{
+				const int32 Size = Scale(Settings, Count);
+				const auto Combine = [Size](const auto& Combinator)
+				{
+					TArray<TAsyncPromise<int32>> Promises;
+					TArray<TAsyncFuture<int32>> Futures;
+					for (int32 Index = 0; Index < Size; ++Index)
+					{
+						Futures.Add(Promises.AddDefaulted_GetRef().GetFuture());
+					}
+					return Time([&Promises, &Futures, &Combinator]()
+					{
+						const auto Combined = Combinator(Futures);
+						for (const TAsyncPromise<int32>& Promise : Promises)
+						{
+							Promise.SetValue(1);
+						}
+						WaitFor(Combined);
+					});
+				};
+
+				Run(Results, Settings, TEXT("WhenAll"), TEXT("AsyncFutures"), Size, Size, [&Combine]()
+				{
+					return Combine([](const TArray<TAsyncFuture<int32>>& Futures) { return WhenAll(Futures); });
+				});
+
+				Run(Results, Settings, TEXT("WhenAny"), TEXT("AsyncFutures"), Size, Size, [&Combine]()
+				{
+					return Combine([](const TArray<TAsyncFuture<int32>>& Futures) { return WhenAny(Futures); });
+				});
+			}
+		}
+
+		static void RunCancellationBenchmarks(TArray<FBenchmarkResult>& Results, const FBenchmarkSettings& Settings)
+		{
+			for (const int32 Count : { 100, 1000 })
+			{
+				const int32 Size = Scale(Settings, Count);
+				Run(Results, Settings, TEXT("Cancellation"), TEXT("AsyncFutures"), Size, Size, [Size]()
+				{
+					TAsyncPromise<void> Promise;
+					FCancellationHandle Cancellation;
+					TArray<TAsyncFuture<void>> Futures;
+					for (int32 Index = 0; Index < Size; ++Index)
+					{
+						Futures.Add(Promise.GetFuture().Then([]() {}, FOptions().Set(Cancellation)));
+					}
+
+					const double Seconds = Time([&Cancellation, &Futures]()
+					{
+						Cancellation.Cancel();
+						WaitFor(WhenAll(Futures));
+					});
+					Promise.SetValue();
+					return Seconds;
+				});
+			}
+		}
+
+		static void RunExecutionBenchmarks(TArray<FBenchmarkResult>& Results, const FBenchmarkSettings& Settings)
+		{
+			const TPair<EAsyncExecution, int32> Executions[] = {
+				{ EAsyncExecution::TaskGraph, 256 },
+				{ EAsyncExecution::TaskGraphMainThread, 256 },
+				{ EAsyncExecution::Thread, 16 }, //Dedicated threads, kept between tasks
+				{ EAsyncExecution::ThreadIfForkSafe, 16 },
+				{ EAsyncExecution::ThreadPool, 256 },
+#if WITH_EDITOR
+				{ EAsyncExecution::LargeThreadPool, 256 },
+#endif
+			};
+
+			for (const TPair<EAsyncExecution, int32>& Execution : Executions)
+			{
+				const int32 Count = Scale(Settings, Execution.Value);
+				const FOptions Options = FOptions().Set(Execution.Key);
+				Run(Results, Settings, TEXT("Execution"), UE::Tasks::Private::GetExecutionName(Execution.Key), Count, Count, [Count, &Options]()
+				{
+					return Time([Count, &Options]() { WaitFor(LaunchAll(Count, Options)); });
+				});
+			}
+		}
+
+		//The same launches and chains on each AsyncFutures.Backend, which is put back afterwards
+		static void RunBackendBenchmarks(TArray<FBenchmarkResult>& Results, const FBenchmarkSettings& Settings)
+		{
+			IConsoleVariable* Backend = IConsoleManager::Get().FindConsoleVariable(TEXT("AsyncFutures.Backend"));
+			const int32 PreviousBackend = Backend->GetInt();
+			const int32 Count = Scale(Settings, 1000);
+
+			for (const TPair<int32, const TCHAR*>& Variant : { TPair<int32, const TCHAR*>(0, TEXT("TaskGraph")), TPair<int32, const TCHAR*>(1, TEXT("Tasks")) })
+			{
+				Backend->Set(Variant.Key);
+				Run(Results, Settings, TEXT("Backend.Launch"), Variant.Value, Count, Count, [Count]()
+				{
+					return Time([Count]() { WaitFor(LaunchAll(Count, FOptions())); });
+				});
+
+				Run(Results, Settings, TEXT("Backend.ChainLatency"), Variant.Value, 16, 16, []()
+				{
+					TAsyncPromise<void> Promise;
+					TAsyncFuture<void> Future = Promise.GetFuture();
+					for (int32 Index = 0; Index < 16; ++Index)
+					{
+						//Fusion would run the whole chain on one task, so each stage gets a new priority to be scheduled on its own
+						Future = Future.Then([]() {}, FOptions().Set(Index % 2 == 0 ? ENamedThreads::AnyThread : ENamedThreads::AnyHiPriThreadNormalTask));
+					}
+					return Time([&Promise, &Future]()
+					{
+						Promise.SetValue();
+						WaitFor(Future);
+					});
+				});
+			}
+
+			Backend->Set(PreviousBackend);
+		}
+	}
+
+	TArray<FBenchmarkResult> RunBenchmarks(const FBenchmarkSettings& Settings)
+	{
+		TArray<FBenchmarkResult> Results;
+		Private::RunLaunchBenchmarks(Results, Settings);
+		Private::RunChainBenchmarks(Results, Settings);
+		Private::RunCombinationBenchmarks(Results, Settings);
+		Private::RunCancellationBenchmarks(Results, Settings);
+		Private::RunExecutionBenchmarks(Results, Settings);
+		Private::RunBackendBenchmarks(Results, Settings);
+		return Results;
+	}
+
+	FString ToJson(const TArray<FBenchmarkResult>& Results)
+	{
+		TArray<TSharedPtr<FJsonValue>> Values;
+		for (const FBenchmarkResult& Result : Results)
+		{
+			const TSharedRef<FJsonObject> Object = MakeShared<FJsonObject>();
+			Object->SetStringField(TEXT("name"), Result.Name);
+			Object->SetStringField(TEXT("variant"), Result.Variant);
+			Object->SetNumberField(TEXT("size"), Result.Size);
+			Object->SetNumberField(TEXT("operations"), Result.Operations);
+			Object->SetNumberField(TEXT("samples"), Result.Samples);
+			Object->SetNumberField(TEXT("opsPerSecond"), Result.OperationsPerSecond);
+			Object->SetNumberField(TEXT("meanUs"), Result.MeanMicroseconds);
+			Object->SetNumberField(TEXT("minUs"), Result.MinMicroseconds);
+			Object->SetNumberField(TEXT("p50Us"), Result.P50Microseconds);
+			Object->SetNumberField(TEXT("p99Us"), Result.P99Microseconds);
+			Values.Add(MakeShared<FJsonValueObject>(Object));
+		}
+
+		const TSharedRef<FJsonObject> Root = MakeShared<FJsonObject>();
+		Root->SetStringField(TEXT("platform"), FPlatformProperties::IniPlatformName());
+		Root->SetNumberField(TEXT("cores"), FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+		Root->SetArrayField(TEXT("results"), Values);
+
+		FString Json;
+		const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+		FJsonSerializer::Serialize(Root, Writer);
+		return Json;
+	}
+
+	FString ToCsv(const TArray<FBenchmarkResult>& Results)
+	{
+		FString Csv = TEXT("Name,Variant,Size,Operations,Samples,OpsPerSecond,MeanUs,MinUs,P50Us,P99Us\n");
+		for (const FBenchmarkResult& Result : Results)
+		{
+			Csv += FString::Printf(TEXT("%s,%s,%d,%d,%d,%.1f,%.2f,%.2f,%.2f,%.2f\n"), *Result.Name, *Result.Variant, Result.Size, Result.Operations, Result.Samples,
+				Result.OperationsPerSecond, Result.MeanMicroseconds, Result.MinMicroseconds, Result.P50Microseconds, Result.P99Microseconds);
+		}
+		return Csv;
+	}
+
+	bool WriteResults(const TArray<FBenchmarkResult>& Results, const FString& Directory, const FString& BaseName)
+	{
+		const FString BasePath = FPaths::Combine(Directory, BaseName);
+		const bool bWroteJson = FFileHelper::SaveStringToFile(ToJson(Results), *(BasePath + TEXT(".json")));
+		const bool bWroteCsv = FFileHelper::SaveStringToFile(ToCsv(Results), *(BasePath + TEXT(".csv")));
+		return bWroteJson && bWroteCsv;
+	}
+
+	FString GetDefaultOutputDirectory()
+	{
+		return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("AsyncFutures"), TEXT("Benchmarks"));
+	}
+}
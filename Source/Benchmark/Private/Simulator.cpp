@@ -0,0 +1,507 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include "Simulator.h"
+
+// Engine Includes
+#include "Containers/Map.h"
+#include "Dom/JsonObject.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+// Module Includes
+#include "BenchmarkModule.h"
+
+namespace UE::Tasks::Benchmark
+{
+	namespace Private
+	{
+		enum class EEvent : uint8
+		{
+			Created,
+			Ready,
+			Ended,
+			Fulfilled
+		};
+
+		struct FEvent
+		{
+			double Time = 0.0;
+			int64 Sequence = 0;
+			int32 Node = INDEX_NONE;
+			EEvent Kind = EEvent::Created;
+		};
+
+		//Earliest first, and in the order they were pushed when they happen at the same time
+		struct FEventOrder
+		{
+			bool operator()(const FEvent& A, const FEvent& B) const
+			{
+				return A.Time < B.Time || (A.Time == B.Time && A.Sequence < B.Sequence);
+			}
+		};
+
+		struct FSimulatedNode
+		{
+			bool bContinuation = false;
+			double Cost = 0.0;
+			int32 Lane = 0;
+			double CreateOffset = 0.0; //From the continuation that created it starting
+			double FulfilOffset = 0.0; //From the continuation that fulfilled it starting
+			double Delay = 0.0; //From being created to being fulfilled, for promises fulfilled by hand outside any captured continuation
+
+			TArray<int32> Continuations;
+			TArray<int32> ForwardsInto;
+			TArray<int32> Creates;
+			TArray<int32> Fulfils;
+
+			//Counts of what still has to happen before it can be queued, and before it's fulfilled, along with the latest time of each
+			int32 StartDeps = 0;
+			double StartTime = 0.0;
+			int32 DoneDeps = 0;
+			double DoneTime = 0.0;
+
+			double Rank = 0.0;
+			int64 ReadySequence = 0;
+			bool bStarted = false;
+			double Fulfilled = -1.0;
+		};
+
+		//Heap order of a lane's queue, the node that comes first is the one a free worker picks
+		struct FQueueOrder
+		{
+			const TArray<FSimulatedNode>& Nodes;
+			const ESimulatedPolicy Policy;
+
+			bool operator()(const int32 A, const int32 B) const
+			{
+				if (Policy == ESimulatedPolicy::Lifo)
+				{
+					return Nodes[A].ReadySequence > Nodes[B].ReadySequence;
+				}
+				if (Policy == ESimulatedPolicy::CriticalPath && Nodes[A].Rank != Nodes[B].Rank)
+				{
+					return Nodes[A].Rank > Nodes[B].Rank;
+				}
+				return Nodes[A].ReadySequence < Nodes[B].ReadySequence;
+			}
+		};
+
+		struct FLane
+		{
+			int32 Free = 0;
+			TArray<int32> Queue;
+		};
+
+		static bool IsPinnedThread(const FString& Thread)
+		{
+			return Thread.StartsWith(TEXT("GameThread")) || Thread.StartsWith(TEXT("RenderThread")) || Thread.StartsWith(TEXT("RHIThread"));
+		}
+
+		class FSimulation
+		{
+		public:
+			FSimulation(const FFutureGraph& Graph, const FSimulationSettings& InSettings)
+				: Settings(InSettings)
+			{
+				Nodes.SetNum(Graph.Nodes.Num());
+				Lanes.AddDefaulted_GetRef().Free = FMath::Max(Settings.Workers, 1);
+				TMap<FString, int32> PinnedLanes;
+
+				for (const FFutureGraphEdge& Edge : Graph.Edges)
+				{
+					if (Edge.Kind == EFutureGraphEdge::Continuation)
+					{
+						Nodes[Edge.From - 1].Continuations.Add(Edge.To - 1);
+						Nodes[Edge.To - 1].bContinuation = true;
+						++Nodes[Edge.To - 1].StartDeps;
+					}
+					else
+					{
+						Nodes[Edge.From - 1].ForwardsInto.Add(Edge.To - 1);
+						++Nodes[Edge.To - 1].DoneDeps;
+					}
+				}
+
+				const auto Ran = [&Graph](const int32 Id) { return Id > 0 && Graph.Nodes[Id - 1].StartedMs >= 0.0; };
+				const auto Offset = [&Graph, this](const int32 Id, const double Time) { return FMath::Clamp(Time - Graph.Nodes[Id - 1].StartedMs, 0.0, Nodes[Id - 1].Cost); };
+
+				for (int32 Index = 0; Index < Nodes.Num(); ++Index)
+				{
+					const FFutureGraphNode& Captured = Graph.Nodes[Index];
+					Nodes[Index].Cost = Captured.StartedMs >= 0.0 && Captured.EndedMs >= Captured.StartedMs ? Captured.EndedMs - Captured.StartedMs : 0.0;
+					if (Settings.bPinNamedThreads && IsPinnedThread(Captured.Thread))
+					{
+						if (!PinnedLanes.Contains(Captured.Thread))
+						{
+							PinnedLanes.Add(Captured.Thread, Lanes.Num());
+							Lanes.AddDefaulted_GetRef().Free = 1;
+						}
+						Nodes[Index].Lane = PinnedLanes[Captured.Thread];
+					}
+				}
+
+				for (int32 Index = 0; Index < Nodes.Num(); ++Index)
+				{
+					const FFutureGraphNode& Captured = Graph.Nodes[Index];
+					FSimulatedNode& Node = Nodes[Index];
+
+					//Being created is a dependency of both starting and, for promises fulfilled by hand, being fulfilled
+					if (Ran(Captured.CreatedBy))
+					{
+						Nodes[Captured.CreatedBy - 1].Creates.Add(Index);
+						Node.CreateOffset = Offset(Captured.CreatedBy, Captured.CreatedMs);
+					}
+					else
+					{
+						Push(FMath::Max(Captured.CreatedMs, 0.0), Index, EEvent::Created);
+						FirstCreated = FMath::Min(FirstCreated, FMath::Max(Captured.CreatedMs, 0.0));
+					}
+
+					if (Node.bContinuation)
+					{
+						++Node.StartDeps;
+						++Node.DoneDeps;
+					}
+					else
+					{
+						++Node.DoneDeps;
+						if (Ran(Captured.FulfilledBy) && Captured.FulfilledMs >= 0.0)
+						{
+							Nodes[Captured.FulfilledBy - 1].Fulfils.Add(Index);
+							Node.FulfilOffset = Offset(Captured.FulfilledBy, Captured.FulfilledMs);
+							++Node.DoneDeps;
+						}
+						else
+						{
+							Node.Delay = FMath::Max(Captured.FulfilledMs - FMath::Max(Captured.CreatedMs, 0.0), 0.0);
+						}
+					}
+
+					//Never fulfilled when it was captured, so it can't be here either
+					if (Captured.FulfilledMs < 0.0)
+					{
+						++Node.DoneDeps;
+					}
+				}
+
+				if (Settings.Policy == ESimulatedPolicy::CriticalPath)
+				{
+					RankNodes();
+				}
+			}
+
+			FSimulationResult Run()
+			{
+				while (Events.Num() > 0)
+				{
+					FEvent Event;
+					Events.HeapPop(Event, FEventOrder());
+					Now = Event.Time;
+					FSimulatedNode& Node = Nodes[Event.Node];
+
+					if (Event.Kind == EEvent::Created)
+					{
+						if (Node.bContinuation)
+						{
+							SatisfyStart(Event.Node, Now);
+						}
+						else
+						{
+							SatisfyDone(Event.Node, Now + Node.Delay);
+						}
+					}
+					else if (Event.Kind == EEvent::Ready)
+					{
+						Node.ReadySequence = ++Sequence;
+						Lanes[Node.Lane].Queue.HeapPush(Event.Node, FQueueOrder{ Nodes, Settings.Policy });
+						Dispatch(Node.Lane);
+					}
+					else if (Event.Kind == EEvent::Ended)
+					{
+						++Lanes[Node.Lane].Free;
+						SatisfyDone(Event.Node, Now);
+						Dispatch(Node.Lane);
+					}
+					else
+					{
+						Node.Fulfilled = Now;
+						for (const int32 Continuation : Node.Continuations)
+						{
+							SatisfyStart(Continuation, Now);
+						}
+						for (const int32 Forwarded : Node.ForwardsInto)
+						{
+							SatisfyDone(Forwarded, Now);
+						}
+					}
+				}
+
+				FSimulationResult Result;
+				Result.Workers = Settings.Workers;
+				Result.Policy = Settings.Policy;
+				double LastFulfilled = FirstCreated;
+				for (const FSimulatedNode& Node : Nodes)
+				{
+					LastFulfilled = FMath::Max(LastFulfilled, Node.Fulfilled);
+					Result.WorkMs += Node.bStarted ? Node.Cost : 0.0;
+					Result.Unfinished += Node.Fulfilled < 0.0 ? 1 : 0;
+				}
+				Result.MakespanMs = FirstCreated < LastFulfilled ? LastFulfilled - FirstCreated : 0.0;
+				Result.Utilization = Result.MakespanMs > 0.0 ? Result.WorkMs / (Result.MakespanMs * (FMath::Max(Settings.Workers, 1) + Lanes.Num() - 1)) : 0.0;
+				return Result;
+			}
+
+		private:
+			void Push(const double Time, const int32 Node, const EEvent Kind)
+			{
+				Events.HeapPush(FEvent{ Time, ++Sequence, Node, Kind }, FEventOrder());
+			}
+
+			void SatisfyStart(const int32 Index, const double Time)
+			{
+				FSimulatedNode& Node = Nodes[Index];
+				Node.StartTime = FMath::Max(Node.StartTime, Time);
+				if (--Node.StartDeps == 0)
+				{
+					Push(Node.StartTime + Settings.DispatchMs, Index, EEvent::Ready);
+				}
+			}
+
+			void SatisfyDone(const int32 Index, const double Time)
+			{
+				FSimulatedNode& Node = Nodes[Index];
+				Node.DoneTime = FMath::Max(Node.DoneTime, Time);
+				if (--Node.DoneDeps == 0)
+				{
+					Push(Node.DoneTime, Index, EEvent::Fulfilled);
+				}
+			}
+
+			void Dispatch(const int32 LaneIndex)
+			{
+				FLane& Lane = Lanes[LaneIndex];
+				while (Lane.Free > 0 && Lane.Queue.Num() > 0)
+				{
+					int32 Index = INDEX_NONE;
+					Lane.Queue.HeapPop(Index, FQueueOrder{ Nodes, Settings.Policy });
+					--Lane.Free;
+
+					FSimulatedNode& Node = Nodes[Index];
+					Node.bStarted = true;
+					Push(Now + Node.Cost, Index, EEvent::Ended);
+					for (const int32 Created : Node.Creates)
+					{
+						Push(Now + Nodes[Created].CreateOffset, Created, EEvent::Created);
+					}
+					for (const int32 Fulfilled : Node.Fulfils)
+					{
+						SatisfyDone(Fulfilled, Now + Nodes[Fulfilled].FulfilOffset);
+					}
+				}
+			}
+
+			//Each node's cost plus the longest chain of work that can only start after it
+			void RankNodes()
+			{
+				TArray<TArray<int32>> Successors;
+				Successors.SetNum(Nodes.Num());
+				for (int32 Index = 0; Index < Nodes.Num(); ++Index)
+				{
+					const FSimulatedNode& Node = Nodes[Index];
+					Successors[Index].Append(Node.Continuations);
+					Successors[Index].Append(Node.Creates);
+					Successors[Index].Append(Node.Fulfils);
+					//Whatever waits on a continuation that returned a future waits on the future too
+					for (const int32 Forwarded : Node.ForwardsInto)
+					{
+						Successors[Index].Append(Nodes[Forwarded].Continuations);
+					}
+				}
+
+				//Iterative so long chains can't overflow the stack. A node reached again while it's still being ranked adds nothing
+				TArray<uint8> Visited;
+				Visited.Init(0, Nodes.Num());
+				TArray<TPair<int32, int32>> Stack;
+				for (int32 Root = 0; Root < Nodes.Num(); ++Root)
+				{
+					if (Visited[Root] != 0)
+					{
+						continue;
+					}
+					Visited[Root] = 1;
+					Stack.Emplace(Root, 0);
+					while (Stack.Num() > 0)
+					{
+						TPair<int32, int32>& Top = Stack.Last();
+						if (Top.Value < Successors[Top.Key].Num())
+						{
+							const int32 Next = Successors[Top.Key][Top.Value++];
+							if (Visited[Next] == 0)
+							{
+								Visited[Next] = 1;
+								Stack.Emplace(Next, 0);
+							}
+							continue;
+						}
+
+						double Longest = 0.0;
+						for (const int32 Successor : Successors[Top.Key])
+						{
+							Longest = Visited[Successor] == 2 ? FMath::Max(Longest, Nodes[Successor].Rank) : Longest;
+						}
+						Nodes[Top.Key].Rank = Nodes[Top.Key].Cost + Longest;
+						Visited[Top.Key] = 2;
+						Stack.Pop();
+					}
+				}
+			}
+
+			const FSimulationSettings Settings;
+			TArray<FSimulatedNode> Nodes;
+			TArray<FLane> Lanes;
+			TArray<FEvent> Events;
+			int64 Sequence = 0;
+			double Now = 0.0;
+			double FirstCreated = TNumericLimits<double>::Max();
+		};
+	}
+
+	FSimulationResult SimulateGraph(const FFutureGraph& Graph, const FSimulationSettings& Settings)
+	{
+		FSimulationResult Result = Private::FSimulation(Graph, Settings).Run();
+
+		//As many workers as there are nodes is as good as unlimited, pinned threads still only get one each
+		FSimulationSettings Unlimited = Settings;
+		Unlimited.Workers = FMath::Max(Graph.Nodes.Num(), 1);
+		Unlimited.Policy = ESimulatedPolicy::Fifo;
+		Result.CriticalPathMs = Private::FSimulation(Graph, Unlimited).Run().MakespanMs;
+		return Result;
+	}
+
+	TArray<FSimulationResult> SimulateGraph(const FFutureGraph& Graph, const TArray<int32>& Workers, const TArray<ESimulatedPolicy>& Policies, const FSimulationSettings& Settings)
+	{
+		TArray<FSimulationResult> Results;
+		for (const ESimulatedPolicy Policy : Policies)
+		{
+			for (const int32 Count : Workers)
+			{
+				FSimulationSettings Simulated = Settings;
+				Simulated.Workers = Count;
+				Simulated.Policy = Policy;
+				Results.Add(SimulateGraph(Graph, Simulated));
+			}
+		}
+		return Results;
+	}
+
+	bool LoadGraph(const FString& JsonPath, FFutureGraph& OutGraph)
+	{
+		FString Json;
+		TSharedPtr<FJsonObject> Root;
+		if (!FFileHelper::LoadFileToString(Json, *JsonPath) || !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Json), Root) || !Root.IsValid())
+		{
+			return false;
+		}
+
+		//Times exported as null weren't recorded
+		const auto GetMs = [](const TSharedPtr<FJsonObject>& Object, const TCHAR* Field)
+		{
+			double Value = -1.0;
+			return Object->TryGetNumberField(Field, Value) ? Value : -1.0;
+		};
+
+		OutGraph = FFutureGraph();
+		Root->TryGetNumberField(TEXT("durationMs"), OutGraph.DurationMs);
+
+		const TArray<TSharedPtr<FJsonValue>>* Nodes = nullptr;
+		const TArray<TSharedPtr<FJsonValue>>* Edges = nullptr;
+		if (!Root->TryGetArrayField(TEXT("nodes"), Nodes) || !Root->TryGetArrayField(TEXT("edges"), Edges))
+		{
+			return false;
+		}
+
+		for (const TSharedPtr<FJsonValue>& Value : *Nodes)
+		{
+			const TSharedPtr<FJsonObject> Object = Value->AsObject();
+			if (!Object.IsValid())
+			{
+				return false;
+			}
+
+			FFutureGraphNode& Node = OutGraph.Nodes.AddDefaulted_GetRef();
+			Node.Id = OutGraph.Nodes.Num();
+			Object->TryGetStringField(TEXT("name"), Node.Name);
+			Object->TryGetStringField(TEXT("file"), Node.File);
+			Object->TryGetNumberField(TEXT("line"), Node.Line);
+			Object->TryGetStringField(TEXT("thread"), Node.Thread);
+			Node.CreatedMs = GetMs(Object, TEXT("createdMs"));
+			Node.ReadyMs = GetMs(Object, TEXT("readyMs"));
+			Node.StartedMs = GetMs(Object, TEXT("startedMs"));
+			Node.EndedMs = GetMs(Object, TEXT("endedMs"));
+			Node.FulfilledMs = GetMs(Object, TEXT("fulfilledMs"));
+			Object->TryGetNumberField(TEXT("createdBy"), Node.CreatedBy);
+			Object->TryGetNumberField(TEXT("fulfilledBy"), Node.FulfilledBy);
+			Object->TryGetBoolField(TEXT("error"), Node.bError);
+			Object->TryGetBoolField(TEXT("critical"), Node.bCritical);
+
+			int32 Id = 0;
+			if (!Object->TryGetNumberField(TEXT("id"), Id) || Id != Node.Id)
+			{
+				UE_LOG(LogAsyncFutureBenchmarks, Error, TEXT("%s: expected node %d, found %d. Nodes have to be numbered from 1 in order"), *JsonPath, Node.Id, Id);
+				return false;
+			}
+		}
+
+		const auto IsNode = [&OutGraph](const int32 Id) { return Id > 0 && Id <= OutGraph.Nodes.Num(); };
+		for (FFutureGraphNode& Node : OutGraph.Nodes)
+		{
+			Node.CreatedBy = IsNode(Node.CreatedBy) ? Node.CreatedBy : 0;
+			Node.FulfilledBy = IsNode(Node.FulfilledBy) ? Node.FulfilledBy : 0;
+		}
+
+		for (const TSharedPtr<FJsonValue>& Value : *Edges)
+		{
+			const TSharedPtr<FJsonObject> Object = Value->AsObject();
+			FFutureGraphEdge Edge;
+			FString Kind;
+			if (!Object.IsValid() || !Object->TryGetNumberField(TEXT("from"), Edge.From) || !Object->TryGetNumberField(TEXT("to"), Edge.To) || !IsNode(Edge.From) || !IsNode(Edge.To))
+			{
+				return false;
+			}
+			Object->TryGetStringField(TEXT("kind"), Kind);
+			Object->TryGetBoolField(TEXT("critical"), Edge.bCritical);
+			Edge.Kind = Kind == TEXT("forwarded") ? EFutureGraphEdge::Forwarded : EFutureGraphEdge::Continuation;
+			OutGraph.Edges.Add(Edge);
+		}
+
+		const TArray<TSharedPtr<FJsonValue>>* CriticalPath = nullptr;
+		if (Root->TryGetArrayField(TEXT("criticalPath"), CriticalPath))
+		{
+			for (const TSharedPtr<FJsonValue>& Value : *CriticalPath)
+			{
+				OutGraph.CriticalPath.Add(int32(Value->AsNumber()));
+			}
+		}
+		return true;
+	}
+
+	const TCHAR* GetPolicyName(const ESimulatedPolicy Policy)
+	{
+		switch (Policy)
+		{
+		case ESimulatedPolicy::Lifo: return TEXT("Lifo");
+		case ESimulatedPolicy::CriticalPath: return TEXT("CriticalPath");
+		default: return TEXT("Fifo");
+		}
+	}
+
+	FString ToCsv(const TArray<FSimulationResult>& Results)
+	{
+		FString Csv = TEXT("Policy,Workers,MakespanMs,WorkMs,CriticalPathMs,Utilization,Unfinished\n");
+		for (const FSimulationResult& Result : Results)
+		{
+			Csv += FString::Printf(TEXT("%s,%d,%.3f,%.3f,%.3f,%.3f,%d\n"), GetPolicyName(Result.Policy), Result.Workers, Result.MakespanMs, Result.WorkMs, Result.CriticalPathMs, Result.Utilization, Result.Unfinished);
+		}
+		return Csv;
+	}
+}
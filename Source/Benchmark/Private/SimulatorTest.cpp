@@ -0,0 +1,61 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include <CoreMinimal.h>
+#include <Misc/AutomationTest.h>
+
+#include "Simulator.h"
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAsyncFuturesSimulatorTest, "AsyncFutures.Benchmark.Simulator", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext | EAutomationTestFlags::ProductFilter)
+
+bool FAsyncFuturesSimulatorTest::RunTest(const FString& Parameters)
+{
+	using namespace UE::Tasks;
+
+	//A ready promise with four 10ms continuations, all of them waiting on it
+	const auto MakeFanOut = [](const TCHAR* Thread)
+	{
+		FFutureGraph Graph;
+		FFutureGraphNode& Root = Graph.Nodes.AddDefaulted_GetRef();
+		Root.Id = 1;
+		Root.CreatedMs = 0.0;
+		Root.FulfilledMs = 0.0;
+		for (int32 Index = 0; Index < 4; ++Index)
+		{
+			FFutureGraphNode& Node = Graph.Nodes.AddDefaulted_GetRef();
+			Node.Id = Graph.Nodes.Num();
+			Node.Thread = Thread;
+			Node.CreatedMs = 0.0;
+			Node.StartedMs = 10.0 * Index;
+			Node.EndedMs = Node.StartedMs + 10.0;
+			Node.FulfilledMs = Node.EndedMs;
+			Graph.Edges.Add(FFutureGraphEdge{ 1, Node.Id, EFutureGraphEdge::Continuation, false });
+		}
+		return Graph;
+	};
+
+	const FFutureGraph FanOut = MakeFanOut(TEXT("Foreground Worker #0"));
+	Benchmark::FSimulationSettings Settings;
+	Settings.Workers = 1;
+	const Benchmark::FSimulationResult OneWorker = Benchmark::SimulateGraph(FanOut, Settings);
+	TestEqual("One worker runs them one after another", OneWorker.MakespanMs, 40.0, 0.001);
+	TestEqual("Critical path is one continuation", OneWorker.CriticalPathMs, 10.0, 0.001);
+
+	Settings.Workers = 4;
+	TestEqual("Four workers run them together", Benchmark::SimulateGraph(FanOut, Settings).MakespanMs, 10.0, 0.001);
+
+	const FFutureGraph GameThread = MakeFanOut(TEXT("GameThread"));
+	TestEqual("Continuations pinned to the game thread don't get more workers", Benchmark::SimulateGraph(GameThread, Settings).MakespanMs, 40.0, 0.001);
+	Settings.bPinNamedThreads = false;
+	TestEqual("Unpinned they do", Benchmark::SimulateGraph(GameThread, Settings).MakespanMs, 10.0, 0.001);
+
+	//A continuation that returned a future isn't fulfilled until that future is
+	FFutureGraph Forwarded = MakeFanOut(TEXT("Foreground Worker #0"));
+	FFutureGraphNode& Inner = Forwarded.Nodes.AddDefaulted_GetRef();
+	Inner.Id = Forwarded.Nodes.Num();
+	Inner.CreatedBy = 2;
+	Inner.CreatedMs = 5.0;
+	Inner.FulfilledMs = 55.0;
+	Forwarded.Edges.Add(FFutureGraphEdge{ Inner.Id, 2, EFutureGraphEdge::Forwarded, false });
+	Settings.bPinNamedThreads = true;
+	TestEqual("Makespan waits on the returned future", Benchmark::SimulateGraph(Forwarded, Settings).MakespanMs, 55.0, 0.001);
+	return true;
+}
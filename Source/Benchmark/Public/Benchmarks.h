@@ -0,0 +1,43 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+
+// Engine Includes
+#include "Containers/Array.h"
+#include "Containers/UnrealString.h"
+#include "CoreTypes.h"
+
+namespace UE::Tasks::Benchmark
+{
+	struct FBenchmarkSettings
+	{
+		int32 Samples = 10; //Timed runs of each benchmark, after one untimed warm up
+		float Scale = 1.0f; //Multiplies the number of operations in each run
+		FString Filter; //Only runs benchmarks whose name contains this
+	};
+
+	//Timings of one benchmark at one size. Each sample runs Operations operations
+	struct FBenchmarkResult
+	{
+		FString Name;
+		FString Variant;
+		int32 Size = 0;
+		int32 Operations = 0;
+		int32 Samples = 0;
+		double OperationsPerSecond = 0.0;
+		double MeanMicroseconds = 0.0; //Per sample
+		double MinMicroseconds = 0.0;
+		double P50Microseconds = 0.0;
+		double P99Microseconds = 0.0;
+	};
+
+	//Blocks the calling thread until every benchmark has run. Work for the game thread is processed while waiting
+	ASYNCFUTUREBENCHMARKS_API TArray<FBenchmarkResult> RunBenchmarks(const FBenchmarkSettings& Settings);
+
+	ASYNCFUTUREBENCHMARKS_API FString ToJson(const TArray<FBenchmarkResult>& Results);
+	ASYNCFUTUREBENCHMARKS_API FString ToCsv(const TArray<FBenchmarkResult>& Results);
+
+	//Writes <BaseName>.json and <BaseName>.csv to the directory, returns false if either couldn't be written
+	ASYNCFUTUREBENCHMARKS_API bool WriteResults(const TArray<FBenchmarkResult>& Results, const FString& Directory, const FString& BaseName);
+	//Saved/AsyncFutures/Benchmarks
+	ASYNCFUTUREBENCHMARKS_API FString GetDefaultOutputDirectory();
+}
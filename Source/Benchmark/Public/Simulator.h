@@ -0,0 +1,55 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#pragma once
+
+// Engine Includes
+#include "Containers/Array.h"
+#include "Containers/UnrealString.h"
+#include "CoreTypes.h"
+
+// Module Includes
+#include "GraphCapture.h"
+
+namespace UE::Tasks::Benchmark
+{
+	//Which ready continuation a free worker picks next
+	enum class ESimulatedPolicy : uint8
+	{
+		Fifo, //In the order they became ready, like the task graph's queues
+		Lifo, //Most recently ready first, like a work stealing worker's own queue
+		CriticalPath //Longest chain of work left behind it first
+	};
+
+	struct FSimulationSettings
+	{
+		int32 Workers = 4;
+		ESimulatedPolicy Policy = ESimulatedPolicy::Fifo;
+		double DispatchMs = 0.0; //Added between a continuation being ready and it being queued
+		bool bPinNamedThreads = true; //Continuations that ran on the game, render or RHI thread only get that one thread
+	};
+
+	struct FSimulationResult
+	{
+		int32 Workers = 0;
+		ESimulatedPolicy Policy = ESimulatedPolicy::Fifo;
+		double MakespanMs = 0.0; //From the first promise being created to the last being fulfilled
+		double WorkMs = 0.0; //Time spent running continuations
+		double CriticalPathMs = 0.0; //The makespan with unlimited workers
+		double Utilization = 0.0; //Of the workers, over the makespan
+		int32 Unfinished = 0; //Promises that were never fulfilled while the graph was captured
+	};
+
+	/**
+	 * Replays a captured graph on simulated workers. Continuations cost what they took to run when captured, and start once
+	 * what they wait on has been fulfilled and a worker is free. Promises fulfilled by hand keep the delay they had when
+	 * captured, measured from the continuation that fulfilled them when there was one, otherwise from when they were created.
+	 */
+	ASYNCFUTUREBENCHMARKS_API FSimulationResult SimulateGraph(const FFutureGraph& Graph, const FSimulationSettings& Settings);
+	//Every combination of worker count and policy
+	ASYNCFUTUREBENCHMARKS_API TArray<FSimulationResult> SimulateGraph(const FFutureGraph& Graph, const TArray<int32>& Workers, const TArray<ESimulatedPolicy>& Policies, const FSimulationSettings& Settings = FSimulationSettings());
+
+	//Reads a graph written by FFutureGraph::Save
+	ASYNCFUTUREBENCHMARKS_API bool LoadGraph(const FString& JsonPath, FFutureGraph& OutGraph);
+
+	ASYNCFUTUREBENCHMARKS_API const TCHAR* GetPolicyName(const ESimulatedPolicy Policy);
+	ASYNCFUTUREBENCHMARKS_API FString ToCsv(const TArray<FSimulationResult>& Results);
+}
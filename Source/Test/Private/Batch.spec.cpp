@@ -0,0 +1,95 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include <CoreMinimal.h>
+#include <AsyncFutures.h>
+
+BEGIN_DEFINE_SPEC(FAsyncFuturesSpec_Batch, "AsyncFutures.Batch", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext)
+
+END_DEFINE_SPEC(FAsyncFuturesSpec_Batch)
+
+void FAsyncFuturesSpec_Batch::Define()
+{
+	It("Completes an empty batch immediately", [this]()
+	{
+		const TArray<int32> Inputs;
+		UE::Tasks::TAsyncFuture<TArray<int32>> Future = UE::Tasks::AsyncBatchAll(Inputs, [](const int32 Input) { return Input; });
+		TestTrue("Future is ready", Future.IsReady());
+		TestEqual("No results", Future.Get().GetValue().Num(), 0);
+	});
+
+	LatentIt("Returns a future per input in order", [this](const auto& Done)
+	{
+		TArray<int32> Inputs;
+		for (int32 i = 0; i < 1000; ++i)
+		{
+			Inputs.Add(i);
+		}
+
+		TArray<UE::Tasks::TAsyncFuture<int32>> Futures = UE::Tasks::AsyncBatch(Inputs, [](const int32 Input) { return Input * 2; });
+		TestEqual("Number of futures", Futures.Num(), Inputs.Num());
+
+		UE::Tasks::WhenAll<int32>(Futures).Then([this, Done](const UE::Tasks::TResult<TArray<int32>>& Result)
+		{
+			TestTrue("All succeeded", Result.HasValue());
+			for (int32 i = 0; i < Result.GetValue().Num(); ++i)
+			{
+				if (!TestEqual("Result", Result.GetValue()[i], i * 2))
+				{
+					break;
+				}
+			}
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Combines every result", [this](const auto& Done)
+	{
+		TArray<int32> Inputs;
+		for (int32 i = 0; i < 20000; ++i)
+		{
+			Inputs.Add(i);
+		}
+
+		UE::Tasks::AsyncBatchAll(Inputs, [](const int32 Input) { return Input + 1; }).Then([this, Done](const UE::Tasks::TResult<TArray<int32>>& Result)
+		{
+			TestTrue("All succeeded", Result.HasValue());
+			TestEqual("Number of results", Result.GetValue().Num(), 20000);
+			TestEqual("Last result", Result.GetValue().Last(), 20000);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Fails with the first error", [this](const auto& Done)
+	{
+		const TArray<int32> Inputs{ 0, 1, 2, 3 };
+		UE::Tasks::AsyncBatchAll(Inputs, [](const int32 Input)
+		{
+			if (Input >= 2)
+			{
+				return UE::Tasks::TResult<int32>(UE::Tasks::FError(UE::Tasks::ERROR_CONTEXT_FUTURE, Input, TEXT("Error Message")));
+			}
+			return UE::Tasks::TResult<int32>(Input);
+		})
+		.Then([this, Done](const UE::Tasks::TResult<TArray<int32>>& Result)
+		{
+			TestTrue("Failed", Result.HasError());
+			TestEqual("First error by input order", Result.GetError().GetCode(), uint64(2));
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Skips work once cancelled", [this](const auto& Done)
+	{
+		UE::Tasks::FCancellationHandle Handle;
+		Handle.Cancel();
+
+		TSharedRef<std::atomic<int32>> Runs = MakeShared<std::atomic<int32>>(0);
+		const TArray<int32> Inputs{ 0, 1, 2, 3 };
+		UE::Tasks::AsyncBatchAll(Inputs, [Runs](const int32 Input) { ++(Runs.Get()); }, UE::Tasks::FOptions().Set(Handle))
+			.Then([this, Done, Runs](const UE::Tasks::TResult<void>& Result)
+			{
+				TestTrue("Cancelled", Result.IsCancelled());
+				TestEqual("Nothing ran", Runs->load(), 0);
+				Done.Execute();
+			}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+}
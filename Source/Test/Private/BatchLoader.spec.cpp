@@ -0,0 +1,96 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include <CoreMinimal.h>
+#include <AsyncFutures.h>
+
+BEGIN_DEFINE_SPEC(FAsyncFuturesSpec_BatchLoader, "AsyncFutures.BatchLoader", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext)
+
+struct FBatchLog
+{
+	FCriticalSection CriticalSection;
+	TArray<TArray<int32>> Batches;
+};
+
+static UE::Tasks::TAsyncBatchLoader<int32, FString> MakeLoader(const TSharedRef<FBatchLog>& Log, const int32 MaxBatchSize, const double Window)
+{
+	return UE::Tasks::TAsyncBatchLoader<int32, FString>([Log](const TArray<int32>& Keys)
+	{
+		{
+			FScopeLock Lock(&Log->CriticalSection);
+			Log->Batches.Add(Keys);
+		}
+
+		TMap<int32, FString> Values;
+		for (const int32 Key : Keys)
+		{
+			if (Key >= 0)
+			{
+				Values.Add(Key, FString::FromInt(Key));
+			}
+		}
+		return UE::Tasks::MakeReadyFuture<TMap<int32, FString>>(MoveTemp(Values));
+	}, MaxBatchSize, Window);
+}
+
+END_DEFINE_SPEC(FAsyncFuturesSpec_BatchLoader)
+
+void FAsyncFuturesSpec_BatchLoader::Define()
+{
+	LatentIt("Loads keys within the window in one batch", [this](const auto& Done)
+	{
+		TSharedRef<FBatchLog> Log = MakeShared<FBatchLog>();
+		UE::Tasks::TAsyncBatchLoader<int32, FString> Loader = MakeLoader(Log, 64, 0.02);
+
+		TArray<UE::Tasks::TAsyncFuture<FString>> Futures;
+		for (int32 Key = 0; Key < 10; ++Key)
+		{
+			Futures.Add(Loader.Load(Key));
+		}
+		Futures.Add(Loader.Load(3));
+
+		UE::Tasks::WhenAll(Futures).Then([this, Done, Log](const UE::Tasks::TResult<TArray<FString>>& Result)
+		{
+			TestTrue("Loaded", Result.HasValue());
+			TestEqual("Value fanned out to its key", Result.GetValue()[7], FString(TEXT("7")));
+			TestEqual("Repeated key shares the load", Result.GetValue()[10], FString(TEXT("3")));
+			TestEqual("One batch", Log->Batches.Num(), 1);
+			TestEqual("Keys are only loaded once", Log->Batches[0].Num(), 10);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Sends a batch as soon as it's full", [this](const auto& Done)
+	{
+		TSharedRef<FBatchLog> Log = MakeShared<FBatchLog>();
+		UE::Tasks::TAsyncBatchLoader<int32, FString> Loader = MakeLoader(Log, 4, 60.0);
+
+		TArray<UE::Tasks::TAsyncFuture<FString>> Futures;
+		for (int32 Key = 0; Key < 8; ++Key)
+		{
+			Futures.Add(Loader.Load(Key));
+		}
+
+		UE::Tasks::WhenAll(Futures).Then([this, Done, Log](const UE::Tasks::TResult<TArray<FString>>& Result)
+		{
+			TestTrue("Loaded", Result.HasValue());
+			TestEqual("Two full batches", Log->Batches.Num(), 2);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Fails keys missing from the batch result", [this](const auto& Done)
+	{
+		TSharedRef<FBatchLog> Log = MakeShared<FBatchLog>();
+		UE::Tasks::TAsyncBatchLoader<int32, FString> Loader = MakeLoader(Log, 64, 60.0);
+
+		UE::Tasks::TAsyncFuture<FString> Found = Loader.Load(1);
+		UE::Tasks::TAsyncFuture<FString> Missing = Loader.Load(-1);
+		Loader.Flush();
+
+		Missing.Then([this, Done, Found](const UE::Tasks::TResult<FString>& Result)
+		{
+			TestEqual("Missing key error", Result.GetError().GetCode(), UE::Tasks::ERROR_BATCH_MISSING_KEY);
+			TestTrue("Other keys still load", Found.Get().HasValue());
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+}
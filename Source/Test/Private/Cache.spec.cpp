@@ -0,0 +1,112 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include <CoreMinimal.h>
+#include <AsyncFutures.h>
+
+BEGIN_DEFINE_SPEC(FAsyncFuturesSpec_Cache, "AsyncFutures.Cache", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext)
+
+END_DEFINE_SPEC(FAsyncFuturesSpec_Cache)
+
+void FAsyncFuturesSpec_Cache::Define()
+{
+	It("Shares the in-flight computation for a key", [this]()
+	{
+		UE::Tasks::TAsyncCache<int32, FString> Cache(16);
+		UE::Tasks::TAsyncPromise<FString> Computation;
+		int32 Calls = 0;
+		auto Factory = [&Calls, Computation]() mutable
+		{
+			++Calls;
+			return Computation.GetFuture();
+		};
+
+		UE::Tasks::TAsyncFuture<FString> First = Cache.GetOrCompute(1, Factory);
+		UE::Tasks::TAsyncFuture<FString> Second = Cache.GetOrCompute(1, Factory);
+		TestEqual("Factory called once", Calls, 1);
+		TestFalse("Value is still computing", First.IsReady() || Second.IsReady());
+
+		Computation.SetValue(FString(TEXT("One")));
+		TestTrue("Both callers completed", First.IsReady() && Second.IsReady());
+		TestEqual("Shared value", Second.Get().GetValue(), FString(TEXT("One")));
+	});
+
+	It("Doesn't break promises when joining or hitting", [this]()
+	{
+		const uint64 BrokenBefore = UE::Tasks::GetNumBrokenPromises();
+		UE::Tasks::TAsyncCache<int32, int32> Cache(16);
+		UE::Tasks::TAsyncPromise<int32> Computation;
+		const auto Factory = [Computation]() { return Computation.GetFuture(); };
+
+		Cache.GetOrCompute(1, Factory);
+		Cache.GetOrCompute(1, Factory);
+		Computation.SetValue(1);
+		Cache.GetOrCompute(1, Factory);
+		TestEqual("Nothing was broken", UE::Tasks::GetNumBrokenPromises(), BrokenBefore);
+	});
+
+	It("Keeps completed values", [this]()
+	{
+		UE::Tasks::TAsyncCache<int32, int32> Cache(16);
+		int32 Calls = 0;
+		const auto Factory = [&Calls]() { ++Calls; return UE::Tasks::MakeReadyFuture<int32>(42); };
+
+		Cache.GetOrCompute(1, Factory);
+		UE::Tasks::TAsyncFuture<int32> Cached = Cache.GetOrCompute(1, Factory);
+		TestEqual("Factory called once", Calls, 1);
+		TestEqual("Cached value", Cached.Get().GetValue(), 42);
+		TestEqual("Number of entries", Cache.Num(), 1);
+	});
+
+	It("Doesn't keep errors", [this]()
+	{
+		UE::Tasks::TAsyncCache<int32, int32> Cache(16);
+		int32 Calls = 0;
+		const auto Factory = [&Calls]() { ++Calls; return UE::Tasks::MakeErrorFuture<int32>(UE::Tasks::MakeCancelledError()); };
+
+		TestTrue("First call failed", Cache.GetOrCompute(1, Factory).Get().HasError());
+		TestTrue("Second call failed", Cache.GetOrCompute(1, Factory).Get().HasError());
+		TestEqual("Factory called for both", Calls, 2);
+		TestEqual("Number of entries", Cache.Num(), 0);
+	});
+
+	It("Evicts the least recently used values over budget", [this]()
+	{
+		static constexpr int32 NumShards = 1;
+		UE::Tasks::TAsyncCache<int32, int32> Cache(2, 0.0, NumShards);
+		int32 Calls = 0;
+		const auto Factory = [&Calls]() { ++Calls; return UE::Tasks::MakeReadyFuture<int32>(0); };
+
+		Cache.GetOrCompute(1, Factory);
+		Cache.GetOrCompute(2, Factory);
+		Cache.GetOrCompute(1, Factory); //1 is now the most recently used
+		Cache.GetOrCompute(3, Factory); //evicts 2
+		TestEqual("Number of entries", Cache.Num(), 2);
+
+		Calls = 0;
+		Cache.GetOrCompute(1, Factory);
+		TestEqual("1 was kept", Calls, 0);
+		Cache.GetOrCompute(2, Factory);
+		TestEqual("2 was evicted", Calls, 1);
+	});
+
+	LatentIt("Recomputes expired values", [this](const auto& Done)
+	{
+		UE::Tasks::TAsyncCache<int32, int32> Cache(16, 0.01);
+		TSharedRef<int32> Calls = MakeShared<int32>(0);
+		Cache.GetOrCompute(1, [Calls]()
+		{
+			int32 Call = ++(Calls.Get());
+			return UE::Tasks::MakeReadyFuture<int32>(MoveTemp(Call));
+		});
+
+		UE::Tasks::WaitAsync(0.05f).Then([this, Done, Cache, Calls]()
+		{
+			UE::Tasks::TAsyncFuture<int32> Recomputed = Cache.GetOrCompute(1, [Calls]()
+			{
+				int32 Call = ++(Calls.Get());
+				return UE::Tasks::MakeReadyFuture<int32>(MoveTemp(Call));
+			});
+			TestEqual("Value was recomputed", Recomputed.Get().GetValue(), 2);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+}
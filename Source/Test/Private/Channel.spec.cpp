@@ -0,0 +1,124 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include <CoreMinimal.h>
+#include <AsyncFutures.h>
+
+BEGIN_DEFINE_SPEC(FAsyncFuturesSpec_Channel, "AsyncFutures.Channel", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext)
+
+END_DEFINE_SPEC(FAsyncFuturesSpec_Channel)
+
+UE::Tasks::TAsyncFuture<int64> SumUntilClosed(UE::Tasks::TAsyncChannel<int32> Channel, int64 Total)
+{
+	return Channel.Receive().Then([Channel, Total](const UE::Tasks::TResult<int32>& Result)
+	{
+		if (Result.HasError())
+		{
+			return UE::Tasks::MakeReadyFuture<int64>(int64(Total));
+		}
+		return SumUntilClosed(Channel, Total + Result.GetValue());
+	});
+}
+
+void FAsyncFuturesSpec_Channel::Define()
+{
+	It("Sends complete immediately while there is capacity", [this]()
+	{
+		UE::Tasks::TAsyncChannel<int32> Channel(2);
+		TestTrue("First send is ready", Channel.Send(1).IsReady());
+		TestTrue("Second send is ready", Channel.Send(2).IsReady());
+		TestFalse("Third send waits for space", Channel.Send(3).IsReady());
+
+		TestEqual("Items are received in order", Channel.Receive().Get().GetValue(), 1);
+		TestEqual("Items are received in order", Channel.Receive().Get().GetValue(), 2);
+		TestEqual("Waiting send was moved into the channel", Channel.Receive().Get().GetValue(), 3);
+	});
+
+	LatentIt("Receive waits for an item", [this](const auto& Done)
+	{
+		UE::Tasks::TAsyncChannel<FString> Channel(1);
+		UE::Tasks::TAsyncFuture<FString> Received = Channel.Receive();
+		TestFalse("Receive is not ready", Received.IsReady());
+
+		Received.Then([this, Done](const FString& Value)
+		{
+			TestEqual("Value", Value, TEXT("Item"));
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+
+		UE::Tasks::Async([Channel]()
+		{
+			Channel.Send(TEXT("Item"));
+		});
+	});
+
+	It("Drains remaining items after closing", [this]()
+	{
+		UE::Tasks::TAsyncChannel<int32> Channel(4);
+		Channel.Send(1);
+		Channel.Close();
+
+		TestTrue("Channel is closed", Channel.IsClosed());
+		TestTrue("Send after close fails", Channel.Send(2).Get().HasError());
+		TestEqual("Remaining item is received", Channel.Receive().Get().GetValue(), 1);
+
+		const UE::Tasks::TResult<int32> Drained = Channel.Receive().Get();
+		TestTrue("Drained channel is an error", Drained.HasError());
+		TestEqual("Drained error code", Drained.GetError().GetCode(), UE::Tasks::ERROR_CHANNEL_CLOSED);
+	});
+
+	LatentIt("Closing fails waiting receivers", [this](const auto& Done)
+	{
+		UE::Tasks::TAsyncChannel<int32> Channel(1);
+		Channel.Receive().Then([this, Done](const UE::Tasks::TResult<int32>& Result)
+		{
+			TestTrue("Result is an error", Result.HasError());
+			TestEqual("Error code", Result.GetError().GetCode(), UE::Tasks::ERROR_CHANNEL_CLOSED);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+
+		Channel.Close();
+	});
+
+	LatentIt("Delivers every item with many producers and consumers", [this](const auto& Done)
+	{
+		static constexpr int32 NumProducers = 4;
+		static constexpr int32 NumConsumers = 4;
+		static constexpr int32 ItemsPerProducer = 500;
+		UE::Tasks::TAsyncChannel<int32> Channel(8);
+
+		TArray<UE::Tasks::TAsyncFuture<int64>> Consumers;
+		for (int32 i = 0; i < NumConsumers; ++i)
+		{
+			Consumers.Add(SumUntilClosed(Channel, 0));
+		}
+
+		TArray<UE::Tasks::TAsyncFuture<void>> Producers;
+		for (int32 i = 0; i < NumProducers; ++i)
+		{
+			Producers.Add(UE::Tasks::Async([Channel]()
+			{
+				TArray<UE::Tasks::TAsyncFuture<void>> Sends;
+				for (int32 Item = 1; Item <= ItemsPerProducer; ++Item)
+				{
+					Sends.Add(Channel.Send(Item));
+				}
+				return UE::Tasks::WhenAll(Sends);
+			}));
+		}
+
+		UE::Tasks::WhenAll(Producers).Then([Channel]()
+		{
+			Channel.Close();
+		});
+
+		UE::Tasks::WhenAll<int64>(Consumers).Then([this, Done](const TArray<int64>& Totals)
+		{
+			int64 Total = 0;
+			for (const int64 Value : Totals)
+			{
+				Total += Value;
+			}
+			TestEqual("Every item was received once", Total, int64(NumProducers) * ItemsPerProducer * (ItemsPerProducer + 1) / 2);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+}
@@ -0,0 +1,71 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include <CoreMinimal.h>
+#include <AsyncFutures.h>
+
+BEGIN_DEFINE_SPEC(FAsyncFuturesSpec_Coalescer, "AsyncFutures.Coalescer", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext)
+
+END_DEFINE_SPEC(FAsyncFuturesSpec_Coalescer)
+
+void FAsyncFuturesSpec_Coalescer::Define()
+{
+	LatentIt("Merges triggers within the window into one run", [this](const auto& Done)
+	{
+		TSharedRef<std::atomic<int32>> Calls = MakeShared<std::atomic<int32>>(0);
+		UE::Tasks::TAsyncCoalescer<int32> Coalescer([Calls]()
+		{
+			int32 Call = ++(*Calls);
+			return UE::Tasks::MakeReadyFuture<int32>(MoveTemp(Call));
+		}, 0.05);
+
+		TArray<UE::Tasks::TAsyncFuture<int32>> Futures;
+		for (int32 i = 0; i < 10; ++i)
+		{
+			Futures.Add(Coalescer.Trigger());
+		}
+		TestEqual("Triggers", Coalescer.GetNumTriggers(), 10);
+		TestEqual("Runs", Coalescer.GetNumRuns(), 1);
+
+		UE::Tasks::WhenAll(Futures).Then([this, Done, Calls](const UE::Tasks::TResult<TArray<int32>>& Result)
+		{
+			TestEqual("Factory called once", Calls->load(), 1);
+			for (const int32 Value : Result.GetValue())
+			{
+				TestEqual("Every trigger shares the run", Value, 1);
+			}
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Merges triggers during a run into one more run", [this](const auto& Done)
+	{
+		UE::Tasks::TAsyncPromise<int32> FirstRun;
+		TSharedRef<std::atomic<int32>> Calls = MakeShared<std::atomic<int32>>(0);
+		UE::Tasks::TAsyncCoalescer<int32> Coalescer([Calls, FirstRun]() mutable
+		{
+			if (++(*Calls) == 1)
+			{
+				return FirstRun.GetFuture();
+			}
+			return UE::Tasks::MakeReadyFuture<int32>(2);
+		});
+
+		UE::Tasks::TAsyncFuture<int32> First = Coalescer.Trigger();
+		UE::Tasks::WaitAsync(0.05f).Then([this, Done, Calls, Coalescer, First, FirstRun](const UE::Tasks::TResult<void>&) mutable
+		{
+			TestEqual("First run started", Calls->load(), 1);
+			UE::Tasks::TAsyncFuture<int32> Second = Coalescer.Trigger();
+			UE::Tasks::TAsyncFuture<int32> Third = Coalescer.Trigger();
+			TestEqual("Runs", Coalescer.GetNumRuns(), 2);
+
+			FirstRun.SetValue(1);
+			UE::Tasks::WhenAll(TArray<UE::Tasks::TAsyncFuture<int32>>{ First, Second, Third }).Then([this, Done, Calls](const UE::Tasks::TResult<TArray<int32>>& Result)
+			{
+				TestEqual("Factory called twice", Calls->load(), 2);
+				TestEqual("First trigger got the first run", Result.GetValue()[0], 1);
+				TestEqual("Later triggers got the second run", Result.GetValue()[1], 2);
+				TestEqual("Later triggers share it", Result.GetValue()[2], 2);
+				Done.Execute();
+			}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+}
@@ -0,0 +1,134 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include <CoreMinimal.h>
+#include <AsyncFutures.h>
+
+#if WITH_ASYNCFUTURES_COROUTINES
+BEGIN_DEFINE_SPEC(FAsyncFuturesSpec_Coroutine, "AsyncFutures.Coroutine", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext)
+
+END_DEFINE_SPEC(FAsyncFuturesSpec_Coroutine)
+
+static UE::Tasks::TAsyncFuture<int32> AddOne(UE::Tasks::TAsyncFuture<int32> Future)
+{
+	const UE::Tasks::TResult<int32> Result = co_await Future;
+	if (Result.HasError())
+	{
+		co_return Result.GetError();
+	}
+	co_return Result.GetValue() + 1;
+}
+
+static UE::Tasks::TAsyncFuture<bool> ResumesOnGameThread()
+{
+	co_await UE::Tasks::ResumeOn(UE::Tasks::Async([]() { return 0; }), UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	co_return IsInGameThread();
+}
+
+static UE::Tasks::TAsyncFuture<void> SwitchesToWorker(TSharedRef<std::atomic_bool> bRanOnGameThread)
+{
+	co_await UE::Tasks::SwitchTo(UE::Tasks::FOptions().Set(ENamedThreads::AnyThread));
+	*bRanOnGameThread = IsInGameThread();
+}
+
+static UE::Tasks::TAsyncFuture<int32> CountWithCoroutine(const int32 Steps)
+{
+	int32 Count = 0;
+	for (int32 i = 0; i < Steps; ++i)
+	{
+		const UE::Tasks::TResult<int32> Result = co_await UE::Tasks::Async([Count]() { return Count + 1; });
+		Count = Result.GetValue();
+	}
+	co_return Count;
+}
+
+static UE::Tasks::TAsyncFuture<int32> CountWithThen(const int32 Steps)
+{
+	UE::Tasks::TAsyncFuture<int32> Future = UE::Tasks::MakeReadyFuture<int32>(0);
+	for (int32 i = 0; i < Steps; ++i)
+	{
+		Future = Future.Then([](const int32 Count) { return Count + 1; });
+	}
+	return Future;
+}
+
+void FAsyncFuturesSpec_Coroutine::Define()
+{
+	It("Doesn't suspend on a ready future", [this]()
+	{
+		UE::Tasks::TAsyncFuture<int32> Future = AddOne(UE::Tasks::MakeReadyFuture<int32>(1));
+		TestTrue("Future is ready", Future.IsReady());
+		TestEqual("Value", Future.Get().GetValue(), 2);
+	});
+
+	It("Resumes when the promise is fulfilled", [this]()
+	{
+		UE::Tasks::TAsyncPromise<int32> Promise;
+		UE::Tasks::TAsyncFuture<int32> Future = AddOne(Promise.GetFuture());
+		TestFalse("Future is not ready", Future.IsReady());
+
+		Promise.SetValue(41);
+		TestTrue("Resumed by SetValue", Future.IsReady());
+		TestEqual("Value", Future.Get().GetValue(), 42);
+	});
+
+	It("Passes errors through", [this]()
+	{
+		UE::Tasks::TAsyncFuture<int32> Future = AddOne(UE::Tasks::MakeErrorFuture<int32>(UE::Tasks::MakeCancelledError()));
+		TestTrue("Future is ready", Future.IsReady());
+		TestTrue("Has error", Future.Get().HasError());
+		TestEqual("Error code", Future.Get().GetError().GetCode(), UE::Tasks::ERROR_CANCELLED);
+	});
+
+	LatentIt("Resumes on the thread chosen in the options", [this](const auto& Done)
+	{
+		ResumesOnGameThread().Then([this, Done](const bool bOnGameThread)
+		{
+			TestTrue("Resumed on the game thread", bOnGameThread);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Switches to the thread chosen in the options", [this](const auto& Done)
+	{
+		TSharedRef<std::atomic_bool> bRanOnGameThread = MakeShared<std::atomic_bool>(true);
+		SwitchesToWorker(bRanOnGameThread).Then([this, Done, bRanOnGameThread]()
+		{
+			TestFalse("Ran on a worker", bRanOnGameThread->load());
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Benchmarks a sequential flow against an equivalent Then chain", [this](const auto& Done)
+	{
+		static constexpr int32 Steps = 2000;
+		struct FBenchmark
+		{
+			int32 ThenCount = 0;
+			int32 CoroutineCount = 0;
+			double ThenSeconds = 0.0;
+			double CoroutineSeconds = 0.0;
+		};
+		TSharedRef<FBenchmark> Benchmark = MakeShared<FBenchmark>();
+
+		const double ThenStart = FPlatformTime::Seconds();
+		CountWithThen(Steps).Then([Benchmark, ThenStart](const int32 ThenCount)
+		{
+			Benchmark->ThenSeconds = FPlatformTime::Seconds() - ThenStart;
+			Benchmark->ThenCount = ThenCount;
+
+			const double CoroutineStart = FPlatformTime::Seconds();
+			return CountWithCoroutine(Steps).Then([Benchmark, CoroutineStart](const int32 CoroutineCount)
+			{
+				Benchmark->CoroutineSeconds = FPlatformTime::Seconds() - CoroutineStart;
+				Benchmark->CoroutineCount = CoroutineCount;
+			});
+		})
+		.Then([this, Done, Benchmark]()
+		{
+			TestEqual("Then chain count", Benchmark->ThenCount, Steps);
+			TestEqual("Coroutine count", Benchmark->CoroutineCount, Steps);
+			AddInfo(FString::Printf(TEXT("%d sequential steps: Then chain %.2fms, coroutine %.2fms"), Steps, Benchmark->ThenSeconds * 1000.0, Benchmark->CoroutineSeconds * 1000.0));
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+}
+#endif
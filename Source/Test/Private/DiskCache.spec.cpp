@@ -0,0 +1,80 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include <CoreMinimal.h>
+#include <AsyncFutures.h>
+#include "HAL/PlatformFileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+BEGIN_DEFINE_SPEC(FAsyncFuturesSpec_DiskCache, "AsyncFutures.DiskCache", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext)
+
+FString Directory;
+
+END_DEFINE_SPEC(FAsyncFuturesSpec_DiskCache)
+
+void FAsyncFuturesSpec_DiskCache::Define()
+{
+	BeforeEach([this]()
+	{
+		Directory = FPaths::Combine(FPaths::AutomationTransientDir(), TEXT("AsyncFuturesDiskCache"));
+		FPlatformFileManager::Get().GetPlatformFile().DeleteDirectoryRecursively(*Directory);
+	});
+
+	AfterEach([this]()
+	{
+		FPlatformFileManager::Get().GetPlatformFile().DeleteDirectoryRecursively(*Directory);
+	});
+
+	LatentIt("Computes and stores a cold entry", [this](const auto& Done)
+	{
+		UE::Tasks::FAsyncDiskCache Cache(Directory);
+		Cache.GetOrCompute<TArray<int32>>(TEXT("Table"), []() { return UE::Tasks::MakeReadyFuture<TArray<int32>>(TArray<int32>{ 1, 2, 3 }); })
+		.Then([this, Done, Cache](const UE::Tasks::TResult<TArray<int32>>& Result)
+		{
+			TestTrue("Computed", Result.HasValue());
+			TestEqual("Number of values", Result.GetValue().Num(), 3);
+			TestTrue("Entry was stored", FPaths::FileExists(Cache.GetPath(TEXT("Table"))));
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Resolves a warm entry from disk", [this](const auto& Done)
+	{
+		UE::Tasks::FAsyncDiskCache(Directory).GetOrCompute<FString>(TEXT("Name"), []() { return UE::Tasks::MakeReadyFuture<FString>(FString(TEXT("Stored"))); })
+		.Then([this](const FString&)
+		{
+			//A new handle, as after a restart
+			return UE::Tasks::FAsyncDiskCache(Directory).GetOrCompute<FString>(TEXT("Name"), []() { return UE::Tasks::MakeReadyFuture<FString>(FString(TEXT("Recomputed"))); });
+		})
+		.Then([this, Done](const UE::Tasks::TResult<FString>& Result)
+		{
+			TestEqual("Value came from disk", Result.GetValue(), FString(TEXT("Stored")));
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Recomputes a corrupt entry", [this](const auto& Done)
+	{
+		UE::Tasks::FAsyncDiskCache Cache(Directory);
+		const TArray<uint8> Garbage{ 1, 2, 3, 4 };
+		FFileHelper::SaveArrayToFile(Garbage, *Cache.GetPath(TEXT("Corrupt")));
+
+		Cache.GetOrCompute<int32>(TEXT("Corrupt"), []() { return UE::Tasks::MakeReadyFuture<int32>(7); })
+		.Then([this, Done](const UE::Tasks::TResult<int32>& Result)
+		{
+			TestEqual("Value was recomputed", Result.GetValue(), 7);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Doesn't store errors", [this](const auto& Done)
+	{
+		UE::Tasks::FAsyncDiskCache Cache(Directory);
+		Cache.GetOrCompute<int32>(TEXT("Failed"), []() { return UE::Tasks::MakeErrorFuture<int32>(UE::Tasks::MakeCancelledError()); })
+		.Then([this, Done, Cache](const UE::Tasks::TResult<int32>& Result)
+		{
+			TestTrue("Failed", Result.HasError());
+			TestFalse("Nothing was stored", FPaths::FileExists(Cache.GetPath(TEXT("Failed"))));
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+}
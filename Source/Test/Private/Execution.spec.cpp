@@ -6,6 +6,8 @@
 BEGIN_DEFINE_SPEC(FAsyncFuturesSpec_Execution, "AsyncFutures.Execution", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext)
 
 bool ContinuationCalled = false;
+int32 PreviousBackend = 0;
+uint32 FirstThreadId = 0;
 
 END_DEFINE_SPEC(FAsyncFuturesSpec_Execution)
 
@@ -64,6 +66,32 @@ void FAsyncFuturesSpec_Execution::Define()
 				Done.Execute();
 			});
 		});
+
+		LatentIt("Reuses the thread of a finished long-running task", [this](const auto& Done)
+		{
+			UE::Tasks::Async([]()
+			{
+				return FPlatformTLS::GetCurrentThreadId();
+			}, UE::Tasks::FOptions().Set(EAsyncExecution::Thread))
+			.Then([this](const uint32 ThreadId)
+			{
+				//Gives the thread time to go back to waiting for work
+				FirstThreadId = ThreadId;
+				return UE::Tasks::WaitAsync(0.1f);
+			})
+			.Then([]()
+			{
+				return UE::Tasks::Async([]()
+				{
+					return FPlatformTLS::GetCurrentThreadId();
+				}, UE::Tasks::FOptions().Set(EAsyncExecution::Thread));
+			})
+			.Then([this, Done](const uint32 ThreadId)
+			{
+				TestEqual(TEXT("Both tasks ran on the same thread"), ThreadId, FirstThreadId);
+				Done.Execute();
+			});
+		});
 	}
 
 	if (FPlatformProcess::SupportsMultithreading() || FForkProcessHelper::IsForkedMultithreadInstance())
@@ -130,4 +158,99 @@ void FAsyncFuturesSpec_Execution::Define()
 		});
 	}
 #endif
+
+	LatentIt("Fuses a sole continuation with the stage before it", [this](const auto& Done)
+	{
+		UE::Tasks::TAsyncPromise<void> Gate;
+		Gate.GetFuture()
+		.Then([]() { return FPlatformTLS::GetCurrentThreadId(); })
+		.Then([](const uint32 StageThread) { return StageThread == FPlatformTLS::GetCurrentThreadId(); })
+		.Then([this, Done](const bool bSameThread)
+		{
+			TestTrue(TEXT("Both stages ran on the same thread"), bSameThread);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+
+		Gate.SetValue();
+	});
+
+	LatentIt("Doesn't fuse continuations targeting another thread", [this](const auto& Done)
+	{
+		UE::Tasks::TAsyncPromise<void> Gate;
+		Gate.GetFuture()
+		.Then([]() { return IsInGameThread(); })
+		.Then([this, Done](const bool bStageOnGameThread)
+		{
+			TestFalse(TEXT("Stage ran on a worker"), bStageOnGameThread);
+			TestTrue(TEXT("Continuation ran on the game thread"), IsInGameThread());
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+
+		Gate.SetValue();
+	});
+
+	LatentIt("Doesn't fuse the continuation of a promise a stage fulfils by hand", [this](const auto& Done)
+	{
+		//Only non-zero while the stage is inside SetValue, so the continuation sees its own thread there only when it ran inline
+		TSharedRef<std::atomic<uint32>> SettingThread = MakeShared<std::atomic<uint32>>(0);
+		UE::Tasks::TAsyncPromise<void> Unrelated;
+		UE::Tasks::TAsyncFuture<bool> Inline = Unrelated.GetFuture().Then([SettingThread]()
+		{
+			return SettingThread->load() == FPlatformTLS::GetCurrentThreadId();
+		});
+
+		UE::Tasks::Async([SettingThread, Unrelated]()
+		{
+			SettingThread->store(FPlatformTLS::GetCurrentThreadId());
+			Unrelated.SetValue();
+			SettingThread->store(0);
+		});
+
+		Inline.Then([this, Done](const bool bInline)
+		{
+			TestFalse(TEXT("Continuation was scheduled"), bInline);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	Describe("On the UE::Tasks backend", [this]()
+	{
+		BeforeEach([this]()
+		{
+			IConsoleVariable* Backend = IConsoleManager::Get().FindConsoleVariable(TEXT("AsyncFutures.Backend"));
+			PreviousBackend = Backend->GetInt();
+			Backend->Set(1);
+		});
+
+		AfterEach([this]()
+		{
+			IConsoleManager::Get().FindConsoleVariable(TEXT("AsyncFutures.Backend"))->Set(PreviousBackend);
+		});
+
+		LatentIt("Runs task graph work on a worker", [this](const auto& Done)
+		{
+			UE::Tasks::Async([this]()
+			{
+				ContinuationCalled = true;
+				return IsInGameThread();
+			}, UE::Tasks::FOptions().Set(EAsyncExecution::TaskGraph).Set(UE::Tasks::EAsyncPriority::High))
+			.Then([this, Done](const bool bOnGameThread)
+			{
+				TestTrue(TEXT("Continuation is called"), ContinuationCalled);
+				TestFalse(TEXT("Work ran on a worker"), bOnGameThread && FPlatformProcess::SupportsMultithreading());
+				Done.Execute();
+			}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+		});
+
+		LatentIt("Still runs work for a named thread on that thread", [this](const auto& Done)
+		{
+			UE::Tasks::Async([]() { return IsInGameThread(); })
+			.Then([this, Done](const bool bStageOnGameThread)
+			{
+				TestFalse(TEXT("Stage ran on a worker"), bStageOnGameThread && FPlatformProcess::SupportsMultithreading());
+				TestTrue(TEXT("Continuation ran on the game thread"), IsInGameThread());
+				Done.Execute();
+			}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+		});
+	});
 }
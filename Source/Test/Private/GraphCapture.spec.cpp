@@ -0,0 +1,92 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include <CoreMinimal.h>
+#include <AsyncFutures.h>
+
+BEGIN_DEFINE_SPEC(FAsyncFuturesSpec_GraphCapture, "AsyncFutures.GraphCapture", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext)
+
+static const UE::Tasks::FFutureGraphNode* FindNode(const UE::Tasks::FFutureGraph& Graph, const FString& Name)
+{
+	return Graph.Nodes.FindByPredicate([&Name](const UE::Tasks::FFutureGraphNode& Node) { return Node.Name == Name; });
+}
+
+END_DEFINE_SPEC(FAsyncFuturesSpec_GraphCapture)
+
+void FAsyncFuturesSpec_GraphCapture::Define()
+{
+	AfterEach([this]()
+	{
+		UE::Tasks::EndGraphCapture();
+	});
+
+	It("Records the promises created while capturing and nothing after", [this]()
+	{
+		UE::Tasks::BeginGraphCapture();
+		const int32 Line = __LINE__ + 1;
+		UE::Tasks::TAsyncPromise<void> Promise;
+		Promise.SetValue();
+		const UE::Tasks::FFutureGraph Graph = UE::Tasks::EndGraphCapture();
+
+		TestFalse("Capture has ended", UE::Tasks::IsCapturingGraph());
+		const UE::Tasks::FFutureGraphNode* Node = Graph.Nodes.FindByPredicate([Line](const UE::Tasks::FFutureGraphNode& Candidate)
+		{
+			return Candidate.Line == Line && Candidate.File.EndsWith(TEXT("GraphCapture.spec.cpp"));
+		});
+		if (TestNotNull("Promise was captured where it was created", Node))
+		{
+			TestTrue("Promise was fulfilled during the capture", Node->FulfilledMs >= Node->CreatedMs && Node->CreatedMs >= 0.0);
+		}
+
+		UE::Tasks::TAsyncPromise<void> After;
+		TestEqual("Promises created after the capture aren't captured", After.State->CaptureId.load(), uint64(0));
+		After.SetValue();
+	});
+
+	It("Escapes control characters in JSON", [this]()
+	{
+		UE::Tasks::FFutureGraph Graph;
+		UE::Tasks::FFutureGraphNode& Node = Graph.Nodes.AddDefaulted_GetRef();
+		Node.Id = 1;
+		Node.Name = TEXT("Two\nLines\tand\x01");
+		TestTrue("Control characters are escaped", Graph.ToJson().Contains(TEXT("Two\\nLines\\tand\\u0001")));
+	});
+
+	LatentIt("Captures what's attached to a root future, with the critical path through it", [this](const auto& Done)
+	{
+		UE::Tasks::TAsyncPromise<int32> Root;
+		UE::Tasks::BeginGraphCapture(Root.GetFuture());
+
+		UE::Tasks::TAsyncPromise<int32> Unrelated;
+		Unrelated.GetFuture().Then([](const UE::Tasks::TResult<int32>&) {}, UE::Tasks::FOptions().Set(TEXT("Unrelated")));
+
+		UE::Tasks::TAsyncFuture<int32> Chain = Root.GetFuture()
+			.Then([](const int32 Value) { return Value + 1; }, UE::Tasks::FOptions().Set(TEXT("First")))
+			.Then([](const int32 Value) { return UE::Tasks::Async([Value]() { return Value * 2; }); }, UE::Tasks::FOptions().Set(TEXT("Second")));
+
+		Root.SetValue(1);
+		Unrelated.SetValue(0);
+
+		Chain.Then([this, Done](const UE::Tasks::TResult<int32>& Result)
+		{
+			const UE::Tasks::FFutureGraph Graph = UE::Tasks::EndGraphCapture();
+			TestEqual("Chain finished", Result.GetValue(), 4);
+			TestNull("Futures not attached to the root weren't captured", FindNode(Graph, TEXT("Unrelated")));
+
+			const UE::Tasks::FFutureGraphNode* First = FindNode(Graph, TEXT("First"));
+			const UE::Tasks::FFutureGraphNode* Second = FindNode(Graph, TEXT("Second"));
+			if (TestNotNull("First continuation was captured", First) && TestNotNull("Second continuation was captured", Second))
+			{
+				TestTrue("Continuation ran after what it waited on was ready", First->StartedMs >= First->ReadyMs && First->ReadyMs >= 0.0);
+				TestTrue("Critical path ends at the last stage", Graph.CriticalPath.Num() > 0 && Graph.CriticalPath.Last() == Second->Id);
+				TestTrue("Critical path goes through the first stage", Graph.CriticalPath.Contains(First->Id));
+				TestTrue("Future returned by the second stage is on the critical path", Graph.Edges.ContainsByPredicate([Second](const UE::Tasks::FFutureGraphEdge& Edge)
+				{
+					return Edge.To == Second->Id && Edge.Kind == UE::Tasks::EFutureGraphEdge::Forwarded && Edge.bCritical;
+				}));
+			}
+
+			TestTrue("Exports Graphviz", Graph.ToDot().StartsWith(TEXT("digraph")) && Graph.ToDot().Contains(TEXT("color=red")));
+			TestTrue("Exports JSON", Graph.ToJson().Contains(TEXT("\"criticalPath\":[")));
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+}
@@ -0,0 +1,112 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include <CoreMinimal.h>
+#include <AsyncFutures.h>
+
+BEGIN_DEFINE_SPEC(FAsyncFuturesSpec_Hedge, "AsyncFutures.Hedge", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext)
+
+END_DEFINE_SPEC(FAsyncFuturesSpec_Hedge)
+
+void FAsyncFuturesSpec_Hedge::Define()
+{
+	LatentIt("Takes the backup when the first attempt is slow and cancels the first", [this](const auto& Done)
+	{
+		UE::Tasks::FHedgePolicy Policy;
+		Policy.Delay = 0.01;
+
+		TSharedRef<std::atomic<int32>> Calls = MakeShared<std::atomic<int32>>(0);
+		UE::Tasks::TAsyncPromise<int32> SlowAttempt;
+		UE::Tasks::Hedge([Calls, SlowAttempt](const UE::Tasks::FCancellationHandle& Handle) mutable
+		{
+			if (++(*Calls) == 1)
+			{
+				UE::Tasks::FCancellationHandle AttemptHandle = Handle;
+				AttemptHandle.Bind(SlowAttempt);
+				return SlowAttempt.GetFuture();
+			}
+			return UE::Tasks::MakeReadyFuture<int32>(2);
+		}, Policy)
+		.Then([this, Done, Calls, SlowAttempt](const UE::Tasks::TResult<int32>& Result)
+		{
+			TestEqual("Backup won", Result.GetValue(), 2);
+			TestEqual("Attempts", Calls->load(), 2);
+			TestTrue("Slow attempt was cancelled", SlowAttempt.Get().IsCancelled());
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Doesn't start a backup when the first attempt is quick", [this](const auto& Done)
+	{
+		UE::Tasks::FHedgePolicy Policy;
+		Policy.Delay = 10.0;
+
+		TSharedRef<std::atomic<int32>> Calls = MakeShared<std::atomic<int32>>(0);
+		UE::Tasks::Hedge([Calls](const UE::Tasks::FCancellationHandle&)
+		{
+			++(*Calls);
+			return UE::Tasks::MakeReadyFuture<int32>(1);
+		}, Policy)
+		.Then([this, Done, Calls](const UE::Tasks::TResult<int32>& Result)
+		{
+			TestEqual("First attempt won", Result.GetValue(), 1);
+			TestEqual("Attempts", Calls->load(), 1);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Waits for the backup when the first attempt fails", [this](const auto& Done)
+	{
+		UE::Tasks::FHedgePolicy Policy;
+		Policy.Delay = 0.01;
+
+		TSharedRef<std::atomic<int32>> Calls = MakeShared<std::atomic<int32>>(0);
+		UE::Tasks::TAsyncPromise<int32> FailingAttempt;
+		UE::Tasks::Hedge([Calls, FailingAttempt](const UE::Tasks::FCancellationHandle&) mutable
+		{
+			if (++(*Calls) == 1)
+			{
+				return FailingAttempt.GetFuture();
+			}
+			FailingAttempt.SetValue(UE::Tasks::FError(2, 1));
+			return UE::Tasks::WaitAsync(0.01f).Then([](const UE::Tasks::TResult<void>&) { return 2; });
+		}, Policy)
+		.Then([this, Done](const UE::Tasks::TResult<int32>& Result)
+		{
+			TestEqual("Backup won", Result.GetValue(), 2);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Makes one attempt when the policy allows none", [this](const auto& Done)
+	{
+		UE::Tasks::FHedgePolicy Policy;
+		Policy.MaxAttempts = 0;
+
+		UE::Tasks::Hedge([](const UE::Tasks::FCancellationHandle&)
+		{
+			return UE::Tasks::MakeReadyFuture<int32>(1);
+		}, Policy)
+		.Then([this, Done](const UE::Tasks::TResult<int32>& Result)
+		{
+			TestEqual("Attempt completed the hedge", Result.GetValue(), 1);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	It("Tracks latency percentiles", [this]()
+	{
+		UE::Tasks::FLatencyTracker Tracker(100);
+		for (int32 i = 1; i <= 200; ++i)
+		{
+			Tracker.AddSample((double)i);
+		}
+
+		TestEqual("Only the most recent samples are kept", Tracker.Num(), 100);
+		TestEqual("Median", Tracker.GetPercentile(0.5), 150.0);
+		TestEqual("p99", Tracker.GetPercentile(0.99), 199.0);
+
+		UE::Tasks::FHedgePolicy Policy;
+		Policy.Tracker = Tracker;
+		Policy.Percentile = 0.5;
+		TestEqual("Hedges after the percentile once there are enough samples", Policy.GetDelay(), 150.0);
+	});
+}
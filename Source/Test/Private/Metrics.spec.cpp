@@ -0,0 +1,97 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include <CoreMinimal.h>
+#include <AsyncFutures.h>
+#include <AsyncFuturesModule.h>
+
+BEGIN_DEFINE_SPEC(FAsyncFuturesSpec_Metrics, "AsyncFutures.Metrics", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext)
+
+int32 PreviousSampleRate = 0;
+
+END_DEFINE_SPEC(FAsyncFuturesSpec_Metrics)
+
+void FAsyncFuturesSpec_Metrics::Define()
+{
+	It("Counts created promises", [this]()
+	{
+		const UE::Tasks::FAsyncFuturesMetrics Before = IAsyncFutures::Get().GetMetrics();
+		UE::Tasks::TAsyncPromise<int32> Promise;
+		Promise.SetValue(1);
+		TestTrue("Promise was created", IAsyncFutures::Get().GetMetrics().PromisesCreated > Before.PromisesCreated);
+	});
+
+	It("Counts cancellations", [this]()
+	{
+		const UE::Tasks::FAsyncFuturesMetrics Before = IAsyncFutures::Get().GetMetrics();
+		UE::Tasks::TAsyncPromise<void> Promise;
+		Promise.Cancel();
+		TestTrue("Cancellation was counted", IAsyncFutures::Get().GetMetrics().Cancellations > Before.Cancellations);
+	});
+
+	LatentIt("Counts scheduled work and how long it took", [this](const auto& Done)
+	{
+		const UE::Tasks::FAsyncFuturesMetrics Before = IAsyncFutures::Get().GetMetrics();
+		UE::Tasks::Async([]() { FPlatformProcess::Sleep(0.001f); }, UE::Tasks::FOptions().Set(EAsyncExecution::ThreadPool))
+		.Then([this, Before]()
+		{
+			//Both are recorded before the work runs
+			const UE::Tasks::FAsyncFuturesMetrics After = IAsyncFutures::Get().GetMetrics();
+			TestTrue("Scheduled on the thread pool", After.GetScheduled(EAsyncExecution::ThreadPool) > Before.GetScheduled(EAsyncExecution::ThreadPool));
+			TestTrue("Schedule latency was recorded", After.ScheduleLatency.Count > Before.ScheduleLatency.Count);
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread))
+		.Then([]() {}, UE::Tasks::FOptions().Set(EAsyncExecution::TaskGraph))
+		.Then([this, Done, Before]()
+		{
+			//Run time is recorded once work returns, and the game thread has returned from the stage before last by the time it runs this
+			TestTrue("Run time was recorded", IAsyncFutures::Get().GetMetrics().RunTime.Count > Before.RunTime.Count);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	It("Buckets durations by powers of two", [this]()
+	{
+		UE::Tasks::FAsyncFuturesHistogram Histogram;
+		for (const uint64 Microseconds : { 0ull, 3ull, 3ull, 100ull })
+		{
+			++Histogram.Buckets[UE::Tasks::FAsyncFuturesHistogram::GetBucket(Microseconds)];
+			++Histogram.Count;
+		}
+
+		TestEqual("Under a microsecond", UE::Tasks::FAsyncFuturesHistogram::GetBucket(0), 0);
+		TestEqual("Median", Histogram.GetPercentile(0.5), 4.0 / 1000000.0);
+		TestEqual("Max", Histogram.GetPercentile(1.0), 128.0 / 1000000.0);
+	});
+
+	Describe("Sampling every call site", [this]()
+	{
+		BeforeEach([this]()
+		{
+			IConsoleVariable* SampleRate = IConsoleManager::Get().FindConsoleVariable(TEXT("AsyncFutures.CallSites.SampleRate"));
+			PreviousSampleRate = SampleRate->GetInt();
+			SampleRate->Set(1);
+			UE::Tasks::ResetCallSiteReport();
+		});
+
+		AfterEach([this]()
+		{
+			IConsoleManager::Get().FindConsoleVariable(TEXT("AsyncFutures.CallSites.SampleRate"))->Set(PreviousSampleRate);
+		});
+
+		LatentIt("Attributes continuation costs to their call site", [this](const auto& Done)
+		{
+			//The cost is recorded once the stage returns, so the check waits for the game thread to be free of it by going through a worker
+			const int32 Line = __LINE__ + 1;
+			UE::Tasks::Async([]() { FPlatformProcess::Sleep(0.001f); }, UE::Tasks::FOptions().Set(ENamedThreads::GameThread))
+			.Then([]() {}, UE::Tasks::FOptions().Set(EAsyncExecution::TaskGraph))
+			.Then([this, Done, Line]()
+			{
+				const TArray<UE::Tasks::FCallSiteStats> Report = UE::Tasks::GetCallSiteReport();
+				const UE::Tasks::FCallSiteStats* Stats = Report.FindByPredicate([Line](const UE::Tasks::FCallSiteStats& Site)
+				{
+					return Site.Line == Line && Site.File.EndsWith(TEXT("Metrics.spec.cpp"));
+				});
+				TestTrue("Call site was recorded", Stats != nullptr && Stats->Count == 1 && Stats->CpuSeconds > 0.0);
+				Done.Execute();
+			}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+		});
+	});
+}
@@ -0,0 +1,130 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include <CoreMinimal.h>
+#include <AsyncFutures.h>
+
+BEGIN_DEFINE_SPEC(FAsyncFuturesSpec_PromiseLeaks, "AsyncFutures.PromiseLeaks", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext)
+
+IConsoleVariable* Track = nullptr;
+IConsoleVariable* Broken = nullptr;
+int32 PreviousTrack = 0;
+int32 PreviousBroken = 0;
+
+END_DEFINE_SPEC(FAsyncFuturesSpec_PromiseLeaks)
+
+void FAsyncFuturesSpec_PromiseLeaks::Define()
+{
+	BeforeEach([this]()
+	{
+		Track = IConsoleManager::Get().FindConsoleVariable(TEXT("AsyncFutures.Promises.Track"));
+		Broken = IConsoleManager::Get().FindConsoleVariable(TEXT("AsyncFutures.Promises.Broken"));
+		PreviousTrack = Track->GetInt();
+		PreviousBroken = Broken->GetInt();
+		Track->Set(1);
+		Broken->Set(2);
+	});
+
+	AfterEach([this]()
+	{
+		Track->Set(PreviousTrack);
+		Broken->Set(PreviousBroken);
+	});
+
+	LatentIt("Fulfils a dropped promise with a broken promise error", [this](const auto& Done)
+	{
+		const uint64 BrokenBefore = UE::Tasks::GetNumBrokenPromises();
+		UE::Tasks::TAsyncFuture<int32> Future;
+		{
+			UE::Tasks::TAsyncPromise<int32> Promise;
+			Future = Promise.GetFuture();
+		}
+
+		Future.Then([this, Done, BrokenBefore](const UE::Tasks::TResult<int32>& Result)
+		{
+			TestTrue("Future has the broken promise error", Result.HasError() && Result.GetError() == UE::Tasks::MakeBrokenPromiseError());
+			TestTrue("Broken promise was counted", UE::Tasks::GetNumBrokenPromises() > BrokenBefore);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Breaks a dropped promise that's only bound to a cancellation handle", [this](const auto& Done)
+	{
+		UE::Tasks::FCancellationHandle Handle;
+		UE::Tasks::TAsyncFuture<int32> Future;
+		{
+			UE::Tasks::TAsyncPromise<int32> Promise;
+			Handle.Bind(Promise);
+			Future = Promise.GetFuture();
+		}
+
+		Future.Then([this, Done, Handle](const UE::Tasks::TResult<int32>& Result)
+		{
+			TestTrue("Future has the broken promise error", Result.HasError() && Result.GetError().GetCode() == UE::Tasks::ERROR_BROKEN_PROMISE);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	It("Doesn't break a promise while a copy of it is alive", [this]()
+	{
+		const uint64 BrokenBefore = UE::Tasks::GetNumBrokenPromises();
+		TOptional<UE::Tasks::TAsyncPromise<void>> Copy;
+		{
+			UE::Tasks::TAsyncPromise<void> Promise;
+			Copy = Promise;
+		}
+		TestFalse("Promise is still waiting", Copy->IsSet());
+		Copy->SetValue();
+		TestEqual("Nothing was broken", UE::Tasks::GetNumBrokenPromises(), BrokenBefore);
+	});
+
+	It("Doesn't break a lazy promise that was never started", [this]()
+	{
+		const uint64 BrokenBefore = UE::Tasks::GetNumBrokenPromises();
+		{
+			UE::Tasks::MakeReadyFuture().Then([]() {}, UE::Tasks::FOptions().Set(UE::Tasks::EStartPolicy::Lazy));
+		}
+		TestEqual("Nothing was broken", UE::Tasks::GetNumBrokenPromises(), BrokenBefore);
+	});
+
+	It("Reports outstanding and broken promises by where they were created", [this]()
+	{
+		const int32 Line = __LINE__ + 1;
+		TOptional<UE::Tasks::TAsyncPromise<int32>> Promise = UE::Tasks::TAsyncPromise<int32>();
+
+		const auto FindSite = [Line](const TArray<UE::Tasks::FPromiseLeakStats>& Report)
+		{
+			return Report.FindByPredicate([Line](const UE::Tasks::FPromiseLeakStats& Site)
+			{
+				return Site.Line == Line && Site.File.EndsWith(TEXT("PromiseLeaks.spec.cpp"));
+			});
+		};
+
+		const TArray<UE::Tasks::FPromiseLeakStats> Outstanding = UE::Tasks::GetPromiseLeakReport();
+		const UE::Tasks::FPromiseLeakStats* Waiting = FindSite(Outstanding);
+		TestTrue("Promise is outstanding", Waiting != nullptr && Waiting->Outstanding == 1 && Waiting->Broken == 0);
+
+		Promise.Reset();
+		const TArray<UE::Tasks::FPromiseLeakStats> Dropped = UE::Tasks::GetPromiseLeakReport();
+		const UE::Tasks::FPromiseLeakStats* Site = FindSite(Dropped);
+		TestTrue("Promise was broken", Site != nullptr && Site->Outstanding == 0 && Site->Broken >= 1);
+	});
+
+	It("Links pending continuations to the promise holding them up", [this]()
+	{
+		UE::Tasks::TAsyncPromise<int32> Root;
+		UE::Tasks::FCancellationHandle Cancellation;
+		UE::Tasks::TAsyncFuture<void> Future = Root.GetFuture().Then([](int32) {}, UE::Tasks::FOptions().Set(TEXT("Stalled")).Set(Cancellation).Set(EAsyncExecution::ThreadPool));
+
+		const TArray<UE::Tasks::FPendingPromise> Pending = UE::Tasks::GetPendingPromises();
+		const UE::Tasks::FPendingPromise* Continuation = Pending.FindByPredicate([](const UE::Tasks::FPendingPromise& Promise) { return Promise.Name == TEXT("Stalled"); });
+		if (TestNotNull("Continuation is pending", Continuation))
+		{
+			const uint64 WaitingOn = Continuation->WaitingOn;
+			TestTrue("Waiting on the root", Pending.ContainsByPredicate([WaitingOn](const UE::Tasks::FPendingPromise& Promise) { return Promise.Id == WaitingOn && Promise.Target.IsEmpty(); }));
+			TestEqual("Runs on the thread pool", Continuation->Target, FString(TEXT("ThreadPool")));
+			TestEqual("Cancellation handle", Continuation->Cancellation, FString(TEXT("not cancelled")));
+		}
+		TestTrue("Chain is described", UE::Tasks::DescribePendingPromises().Contains(TEXT("'Stalled' on ThreadPool")));
+
+		Root.SetValue(1);
+	});
+}
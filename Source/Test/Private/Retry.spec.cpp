@@ -0,0 +1,131 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include <CoreMinimal.h>
+#include <AsyncFutures.h>
+
+BEGIN_DEFINE_SPEC(FAsyncFuturesSpec_Retry, "AsyncFutures.Retry", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext)
+
+static UE::Tasks::FRetryPolicy FastPolicy(const int32 MaxAttempts)
+{
+	UE::Tasks::FRetryPolicy Policy;
+	Policy.MaxAttempts = MaxAttempts;
+	Policy.InitialDelay = 0.001;
+	Policy.MaxDelay = 0.01;
+	return Policy;
+}
+
+END_DEFINE_SPEC(FAsyncFuturesSpec_Retry)
+
+void FAsyncFuturesSpec_Retry::Define()
+{
+	LatentIt("Retries until the factory succeeds", [this](const auto& Done)
+	{
+		TSharedRef<std::atomic<int32>> Calls = MakeShared<std::atomic<int32>>(0);
+		UE::Tasks::Retry([Calls]()
+		{
+			if (++(*Calls) < 3)
+			{
+				return UE::Tasks::MakeErrorFuture<int32>(UE::Tasks::FError(2, 1));
+			}
+			return UE::Tasks::MakeReadyFuture<int32>(7);
+		}, FastPolicy(5))
+		.Then([this, Done, Calls](const UE::Tasks::TResult<int32>& Result)
+		{
+			TestTrue("Succeeded", Result.HasValue());
+			TestEqual("Value", Result.GetValue(), 7);
+			TestEqual("Attempts", Calls->load(), 3);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Gives up with the last error after the max attempts", [this](const auto& Done)
+	{
+		TSharedRef<std::atomic<int32>> Calls = MakeShared<std::atomic<int32>>(0);
+		UE::Tasks::Retry([Calls]()
+		{
+			++(*Calls);
+			return UE::Tasks::MakeErrorFuture<void>(UE::Tasks::FError(2, 1));
+		}, FastPolicy(3))
+		.Then([this, Done, Calls](const UE::Tasks::TResult<void>& Result)
+		{
+			TestTrue("Failed", Result.HasError());
+			TestEqual("Error code", Result.GetError().GetCode(), (uint64)1);
+			TestEqual("Attempts", Calls->load(), 3);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Only retries the errors the policy allows", [this](const auto& Done)
+	{
+		TSharedRef<std::atomic<int32>> Calls = MakeShared<std::atomic<int32>>(0);
+		UE::Tasks::Retry([Calls]()
+		{
+			return UE::Tasks::MakeErrorFuture<int32>(UE::Tasks::FError(2, ++(*Calls)));
+		}, FastPolicy(5).RetryOn(2, 1))
+		.Then([this, Done, Calls](const UE::Tasks::TResult<int32>& Result)
+		{
+			TestEqual("Stopped on the first unlisted code", Result.GetError().GetCode(), (uint64)2);
+			TestEqual("Attempts", Calls->load(), 2);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Stops retrying once the deadline has passed", [this](const auto& Done)
+	{
+		UE::Tasks::FRetryPolicy Policy = FastPolicy(1000);
+		Policy.InitialDelay = 0.05;
+		Policy.Jitter = 0.0;
+		Policy.Deadline = 0.12;
+
+		TSharedRef<std::atomic<int32>> Calls = MakeShared<std::atomic<int32>>(0);
+		UE::Tasks::Retry([Calls]()
+		{
+			++(*Calls);
+			return UE::Tasks::MakeErrorFuture<void>(UE::Tasks::FError(2, 1));
+		}, Policy)
+		.Then([this, Done, Calls](const UE::Tasks::TResult<void>& Result)
+		{
+			TestTrue("Failed", Result.HasError());
+			TestTrue("Attempts were cut short", Calls->load() < 1000);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Stops retrying when cancelled between attempts", [this](const auto& Done)
+	{
+		UE::Tasks::FRetryPolicy Policy = FastPolicy(5);
+		Policy.InitialDelay = 10.0;
+		Policy.MaxDelay = 10.0;
+
+		UE::Tasks::FCancellationHandle Handle;
+		TSharedRef<std::atomic<int32>> Calls = MakeShared<std::atomic<int32>>(0);
+		UE::Tasks::TAsyncFuture<void> Future = UE::Tasks::Retry([Calls]()
+		{
+			++(*Calls);
+			return UE::Tasks::MakeErrorFuture<void>(UE::Tasks::FError(2, 1));
+		}, Policy, UE::Tasks::FOptions().Set(Handle));
+
+		UE::Tasks::WaitAsync(0.05f).Then([Handle](const UE::Tasks::TResult<void>&) mutable { Handle.Cancel(); });
+		Future.Then([this, Done, Calls](const UE::Tasks::TResult<void>& Result)
+		{
+			TestTrue("Cancelled", Result.IsCancelled());
+			TestEqual("Attempts", Calls->load(), 1);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	It("Adds jitter and caps the backoff", [this]()
+	{
+		UE::Tasks::FRetryPolicy Policy;
+		Policy.InitialDelay = 1.0;
+		Policy.MaxDelay = 4.0;
+		Policy.Multiplier = 2.0;
+		Policy.Jitter = 0.5;
+
+		for (int32 Attempt = 1; Attempt <= 6; ++Attempt)
+		{
+			const double Expected = FMath::Min(4.0, FMath::Pow(2.0, (double)(Attempt - 1)));
+			const double Delay = Policy.GetDelay(Attempt);
+			TestTrue("Delay is within the jitter", Delay <= Expected && Delay >= Expected * 0.5);
+		}
+	});
+}
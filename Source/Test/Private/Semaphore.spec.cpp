@@ -0,0 +1,98 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include <CoreMinimal.h>
+#include <AsyncFutures.h>
+
+BEGIN_DEFINE_SPEC(FAsyncFuturesSpec_Semaphore, "AsyncFutures.Semaphore", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext)
+
+END_DEFINE_SPEC(FAsyncFuturesSpec_Semaphore)
+
+void FAsyncFuturesSpec_Semaphore::Define()
+{
+	It("Acquires immediately while permits are available", [this]()
+	{
+		UE::Tasks::FAsyncSemaphore Semaphore(2);
+		UE::Tasks::TAsyncFuture<void> First = Semaphore.Acquire();
+		UE::Tasks::TAsyncFuture<void> Second = Semaphore.Acquire();
+
+		TestTrue("First permit is ready", First.IsReady());
+		TestTrue("Second permit is ready", Second.IsReady());
+		TestEqual("Available permits", Semaphore.GetAvailable(), 0);
+		TestFalse("Can't try to acquire an exhausted semaphore", Semaphore.TryAcquire());
+
+		Semaphore.Release();
+		Semaphore.Release();
+	});
+
+	LatentIt("Waits for a release when exhausted", [this](const auto& Done)
+	{
+		UE::Tasks::FAsyncSemaphore Semaphore(1);
+		Semaphore.Acquire();
+
+		UE::Tasks::TAsyncFuture<void> Waiting = Semaphore.Acquire();
+		TestFalse("Permit is not ready", Waiting.IsReady());
+
+		Waiting.Then([this, Done, Semaphore]()
+		{
+			TestEqual("Permit was handed over", Semaphore.GetAvailable(), 0);
+			Semaphore.Release();
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+
+		Semaphore.Release();
+	});
+
+	LatentIt("Limits the number of concurrent functions", [this](const auto& Done)
+	{
+		static constexpr int32 MaxConcurrency = 2;
+		UE::Tasks::FAsyncSemaphore Semaphore(MaxConcurrency);
+		TSharedRef<std::atomic<int32>> Running = MakeShared<std::atomic<int32>>(0);
+		TSharedRef<std::atomic<int32>> Peak = MakeShared<std::atomic<int32>>(0);
+
+		TArray<UE::Tasks::TAsyncFuture<int32>> Futures;
+		for (int32 i = 0; i < 16; ++i)
+		{
+			Futures.Add(Semaphore.Run([Running, Peak, i]()
+			{
+				const int32 Current = ++(Running.Get());
+				int32 Observed = Peak->load();
+				while (Current > Observed && !Peak->compare_exchange_weak(Observed, Current)) {}
+
+				FPlatformProcess::Sleep(0.01f);
+				--(Running.Get());
+				return i;
+			}));
+		}
+
+		UE::Tasks::WhenAll<int32>(Futures).Then([this, Done, Peak, Semaphore](const UE::Tasks::TResult<TArray<int32>>& Result)
+		{
+			TestTrue("All functions completed", Result.HasValue());
+			TestEqual("Number of results", Result.GetValue().Num(), 16);
+			TestTrue("Concurrency was limited", Peak->load() <= MaxConcurrency);
+			TestEqual("All permits were returned", Semaphore.GetAvailable(), MaxConcurrency);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Holds the permit until a returned future completes", [this](const auto& Done)
+	{
+		UE::Tasks::FAsyncSemaphore Semaphore(1);
+		UE::Tasks::TAsyncPromise<int32> Inner;
+
+		UE::Tasks::TAsyncFuture<int32> Limited = Semaphore.Run([Inner]() mutable
+		{
+			return Inner.GetFuture();
+		});
+
+		UE::Tasks::WaitAsync(0.05f).Then([this, Semaphore, Inner]()
+		{
+			TestEqual("Permit is still held", Semaphore.GetAvailable(), 0);
+			Inner.SetValue(3);
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+
+		Limited.Then([this, Done, Semaphore](int32 Value)
+		{
+			TestEqual("Value", Value, 3);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+}
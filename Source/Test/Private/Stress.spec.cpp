@@ -0,0 +1,237 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include <CoreMinimal.h>
+#include <AsyncFutures.h>
+#include <HAL/Thread.h>
+#include <Math/RandomStream.h>
+
+namespace AsyncFuturesStress
+{
+	static constexpr int32 NotSeen = TNumericLimits<int32>::Min();
+	static constexpr int32 Cancelled = -2;
+	static constexpr int32 OtherError = -3;
+	static constexpr int32 FulfilledAfterRace = -1;
+
+	//A continuation attached during the race and the number of times its function ran
+	struct FAttached
+	{
+		UE::Tasks::TAsyncFuture<void> Future;
+		TSharedRef<std::atomic<int32>, ESPMode::ThreadSafe> Runs;
+	};
+
+	//One shared promise state that every thread races operations against
+	struct FRound
+	{
+		UE::Tasks::TAsyncPromise<int32> Promise;
+		UE::Tasks::FCancellationHandle Cancellation;
+
+		FCriticalSection CriticalSection;
+		TArray<FAttached> Attached;
+
+		//Every continuation has to see the same result, whichever thread fulfilled the promise
+		std::atomic<int32> Seen = NotSeen;
+		std::atomic<int32> Mismatches = 0;
+
+		void Observe(const int32 Encoded)
+		{
+			int32 Expected = NotSeen;
+			if (!Seen.compare_exchange_strong(Expected, Encoded) && Expected != Encoded)
+			{
+				++Mismatches;
+			}
+		}
+	};
+
+	template<typename T>
+	static int32 Encode(const UE::Tasks::TResult<T>& Result, TFunctionRef<int32(const T&)> GetValue)
+	{
+		if (Result.HasValue())
+		{
+			return GetValue(Result.GetValue());
+		}
+		return Result.IsCancelled() ? Cancelled : OtherError;
+	}
+}
+
+BEGIN_DEFINE_SPEC(FAsyncFuturesSpec_Stress, "AsyncFutures.Stress", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext)
+
+END_DEFINE_SPEC(FAsyncFuturesSpec_Stress)
+
+void FAsyncFuturesSpec_Stress::Define()
+{
+	using namespace AsyncFuturesStress;
+
+	It("Keeps its invariants with threads racing on shared promises", [this]()
+	{
+		const int32 NumThreads = FMath::Clamp(FPlatformMisc::NumberOfCoresIncludingHyperthreads(), 4, 16);
+		const int32 NumRounds = 500;
+		const int32 OpsPerRound = 8;
+		const int32 Seed = FMath::Rand();
+		AddInfo(FString::Printf(TEXT("Seed %d, %d threads"), Seed, NumThreads));
+
+		//Shared with the continuations, a cancelled continuation's function can still be running after its future completes
+		TArray<TSharedRef<FRound, ESPMode::ThreadSafe>> Rounds;
+		for (int32 Round = 0; Round < NumRounds; ++Round)
+		{
+			Rounds.Add(MakeShared<FRound, ESPMode::ThreadSafe>());
+		}
+
+		//Continuations whose futures are dropped straight away still have to run exactly once
+		const TSharedRef<std::atomic<int32>, ESPMode::ThreadSafe> DroppedAttached = MakeShared<std::atomic<int32>, ESPMode::ThreadSafe>(0);
+		const TSharedRef<std::atomic<int32>, ESPMode::ThreadSafe> DroppedRuns = MakeShared<std::atomic<int32>, ESPMode::ThreadSafe>(0);
+		std::atomic<int64> TotalOps = 0;
+		std::atomic<int32> Ready = 0;
+
+		const auto Race = [&Rounds, &TotalOps, &Ready, NumThreads, OpsPerRound, DroppedAttached, DroppedRuns](const int32 ThreadIndex, const int32 ThreadSeed)
+		{
+			FRandomStream Random(ThreadSeed);
+			++Ready;
+			while (Ready.load() < NumThreads)
+			{
+				FPlatformProcess::Yield();
+			}
+
+			for (const TSharedRef<FRound, ESPMode::ThreadSafe>& RoundRef : Rounds)
+			{
+				FRound& Round = *RoundRef;
+				for (int32 Op = 0; Op < OpsPerRound; ++Op)
+				{
+					const int32 Choice = Random.RandRange(0, 9);
+					if (Choice == 0)
+					{
+						Round.Promise.SetValue(ThreadIndex);
+					}
+					else if (Choice == 1)
+					{
+						Round.Promise.Cancel();
+					}
+					else if (Choice == 2)
+					{
+						Round.Cancellation.Cancel();
+					}
+					else if (Choice <= 5)
+					{
+						UE::Tasks::FOptions Options = UE::Tasks::FOptions().Set(Random.RandRange(0, 1) == 0 ? EAsyncExecution::TaskGraph : EAsyncExecution::ThreadPool);
+						if (Random.RandRange(0, 1) == 0)
+						{
+							Options.Set(Round.Cancellation);
+						}
+
+						const TSharedRef<std::atomic<int32>, ESPMode::ThreadSafe> Runs = MakeShared<std::atomic<int32>, ESPMode::ThreadSafe>(0);
+						UE::Tasks::TAsyncFuture<void> Future = Round.Promise.GetFuture().Then([RoundRef, Runs](const UE::Tasks::TResult<int32>& Result)
+						{
+							++(*Runs);
+							RoundRef->Observe(Encode<int32>(Result, [](const int32& Value) { return Value; }));
+						}, Options);
+
+						FScopeLock Lock(&Round.CriticalSection);
+						Round.Attached.Add(FAttached{ MoveTemp(Future), Runs });
+					}
+					else if (Choice == 6)
+					{
+						const TArray<UE::Tasks::TAsyncFuture<int32>> Futures = { Round.Promise.GetFuture(), Round.Promise.GetFuture() };
+						const TSharedRef<std::atomic<int32>, ESPMode::ThreadSafe> Runs = MakeShared<std::atomic<int32>, ESPMode::ThreadSafe>(0);
+						UE::Tasks::TAsyncFuture<void> Future = UE::Tasks::WhenAll(Futures).Then([RoundRef, Runs](const UE::Tasks::TResult<TArray<int32>>& Result)
+						{
+							++(*Runs);
+							RoundRef->Observe(Encode<TArray<int32>>(Result, [](const TArray<int32>& Values) { return Values[0]; }));
+						});
+
+						FScopeLock Lock(&Round.CriticalSection);
+						Round.Attached.Add(FAttached{ MoveTemp(Future), Runs });
+					}
+					else if (Choice == 7)
+					{
+						++(*DroppedAttached);
+						Round.Promise.GetFuture().Then([DroppedRuns](const UE::Tasks::TResult<int32>&) { ++(*DroppedRuns); });
+					}
+					else if (Choice == 8)
+					{
+						//Copies of the promise coming and going mustn't break it
+						const UE::Tasks::TAsyncPromise<int32> Copy = Round.Promise;
+					}
+					else
+					{
+						UE::Tasks::TAsyncFuture<int32> Future = Round.Promise.GetFuture();
+						if (Future.IsReady())
+						{
+							Round.Observe(Encode<int32>(Future.Get(), [](const int32& Value) { return Value; }));
+						}
+					}
+				}
+				TotalOps += OpsPerRound;
+			}
+		};
+
+		const double Start = FPlatformTime::Seconds();
+		{
+			TArray<TUniquePtr<FThread>> Threads;
+			for (int32 ThreadIndex = 0; ThreadIndex < NumThreads; ++ThreadIndex)
+			{
+				Threads.Add(MakeUnique<FThread>(TEXT("AsyncFuturesStress"), [&Race, ThreadIndex, Seed]() { Race(ThreadIndex, Seed + ThreadIndex); }));
+			}
+			for (const TUniquePtr<FThread>& Thread : Threads)
+			{
+				Thread->Join();
+			}
+		}
+		const double RaceSeconds = FPlatformTime::Seconds() - Start;
+		AddInfo(FString::Printf(TEXT("%lld operations in %.3fs, %.0f ops/s"), TotalOps.load(), RaceSeconds, TotalOps.load() / FMath::Max(RaceSeconds, 0.000001)));
+
+		//Anything left waiting gets a value now, after which every continuation has to complete
+		TArray<UE::Tasks::TAsyncFuture<void>> Everything;
+		for (const TSharedRef<FRound, ESPMode::ThreadSafe>& Round : Rounds)
+		{
+			Round->Promise.SetValue(FulfilledAfterRace);
+			for (const FAttached& Attached : Round->Attached)
+			{
+				Everything.Add(Attached.Future);
+			}
+		}
+
+		const TSharedRef<FEventRef, ESPMode::ThreadSafe> Completed = MakeShared<FEventRef, ESPMode::ThreadSafe>();
+		UE::Tasks::WhenAll(Everything).Then([Completed](const UE::Tasks::TResult<void>&) { (*Completed)->Trigger(); });
+		const bool bCompleted = (*Completed)->Wait(FTimespan::FromSeconds(10.0));
+		if (!TestTrue("No continuation was left waiting", bCompleted))
+		{
+			int32 Waiting = 0;
+			for (const UE::Tasks::TAsyncFuture<void>& Future : Everything)
+			{
+				Waiting += Future.IsReady() ? 0 : 1;
+			}
+			AddError(FString::Printf(TEXT("%d of %d continuations never completed"), Waiting, Everything.Num()));
+			return;
+		}
+
+		const double DroppedDeadline = FPlatformTime::Seconds() + 10.0;
+		while (DroppedRuns->load() < DroppedAttached->load() && FPlatformTime::Seconds() < DroppedDeadline)
+		{
+			FPlatformProcess::Sleep(0.001f);
+		}
+		TestEqual("Continuations with dropped futures ran once", DroppedRuns->load(), DroppedAttached->load());
+
+		int32 RanTwice = 0;
+		int32 NeverRan = 0;
+		int32 Mismatches = 0;
+		int32 WrongValue = 0;
+		for (const TSharedRef<FRound, ESPMode::ThreadSafe>& Round : Rounds)
+		{
+			Mismatches += Round->Mismatches.load();
+			const int32 Final = Encode<int32>(Round->Promise.Get(), [](const int32& Value) { return Value; });
+			const int32 Seen = Round->Seen.load();
+			WrongValue += (Seen != NotSeen && Seen != Final) ? 1 : 0;
+
+			for (const FAttached& Attached : Round->Attached)
+			{
+				const int32 Runs = Attached.Runs->load();
+				RanTwice += Runs > 1 ? 1 : 0;
+				//Only a cancelled continuation is allowed to skip its function
+				NeverRan += (Runs == 0 && !Attached.Future.Get().IsCancelled()) ? 1 : 0;
+			}
+		}
+
+		TestEqual("No continuation ran more than once", RanTwice, 0);
+		TestEqual("Every continuation that wasn't cancelled ran", NeverRan, 0);
+		TestEqual("Every continuation saw the same result", Mismatches, 0);
+		TestEqual("Continuations saw the value the promise kept", WrongValue, 0);
+	});
+}
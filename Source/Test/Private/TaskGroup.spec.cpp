@@ -0,0 +1,81 @@
+// Copyright Dominic Curry. All Rights Reserved.
+#include <CoreMinimal.h>
+#include <AsyncFutures.h>
+
+BEGIN_DEFINE_SPEC(FAsyncFuturesSpec_TaskGroup, "AsyncFutures.TaskGroup", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext)
+
+END_DEFINE_SPEC(FAsyncFuturesSpec_TaskGroup)
+
+void FAsyncFuturesSpec_TaskGroup::Define()
+{
+	It("Joins immediately when empty", [this]()
+	{
+		UE::Tasks::FTaskGroup Group;
+		UE::Tasks::TAsyncFuture<void> Joined = Group.Join();
+		TestTrue("Join is ready", Joined.IsReady());
+		TestTrue("Join succeeded", Joined.Get().HasValue());
+	});
+
+	It("Waits for every child before joining", [this]()
+	{
+		UE::Tasks::FTaskGroup Group;
+		UE::Tasks::TAsyncPromise<int32> First;
+		UE::Tasks::TAsyncPromise<void> Second;
+		Group.Add(First.GetFuture());
+		Group.Add(Second.GetFuture());
+
+		UE::Tasks::TAsyncFuture<void> Joined = Group.Join();
+		TestFalse("Join waits for both children", Joined.IsReady());
+
+		First.SetValue(1);
+		TestFalse("Join waits for the second child", Joined.IsReady());
+
+		Second.SetValue();
+		TestTrue("Join is ready", Joined.IsReady());
+		TestTrue("Join succeeded", Joined.Get().HasValue());
+	});
+
+	It("Joins with the first error", [this]()
+	{
+		UE::Tasks::FTaskGroup Group;
+		Group.Add(UE::Tasks::MakeErrorFuture<int32>(UE::Tasks::FError(UE::Tasks::ERROR_CONTEXT_FUTURE, UE::Tasks::ERROR_INVALID_ARGUMENT, TEXT("First"))));
+		Group.Add(UE::Tasks::MakeReadyFuture<int32>(1));
+
+		UE::Tasks::TAsyncFuture<void> Joined = Group.Join();
+		TestTrue("Join is ready", Joined.IsReady());
+		TestTrue("Join failed", Joined.Get().HasError());
+		TestEqual("Error code", Joined.Get().GetError().GetCode(), UE::Tasks::ERROR_INVALID_ARGUMENT);
+	});
+
+	It("Cancels outstanding children when destroyed", [this]()
+	{
+		UE::Tasks::TAsyncPromise<int32> Child;
+		UE::Tasks::TAsyncFuture<void> Joined;
+		{
+			UE::Tasks::FTaskGroup Group;
+			Group.Add(Child.GetFuture());
+			Joined = Group.Join();
+		}
+
+		TestTrue("Child was cancelled", Child.IsSet() && Child.Get().IsCancelled());
+		TestTrue("Join completed", Joined.IsReady());
+		TestTrue("Join reports the cancellation", Joined.Get().IsCancelled());
+	});
+
+	LatentIt("Joins launched work", [this](const auto& Done)
+	{
+		TSharedRef<UE::Tasks::FTaskGroup> Group = MakeShared<UE::Tasks::FTaskGroup>();
+		TSharedRef<std::atomic<int32>> Counter = MakeShared<std::atomic<int32>>(0);
+		for (int32 i = 0; i < 64; ++i)
+		{
+			Group->Launch([Counter]() { ++(Counter.Get()); });
+		}
+
+		Group->Join().Then([this, Done, Group, Counter](const UE::Tasks::TResult<void>& Result)
+		{
+			TestTrue("Join succeeded", Result.HasValue());
+			TestEqual("All children ran", Counter->load(), 64);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+}
@@ -1,9 +1,12 @@
 // Copyright Dominic Curry. All Rights Reserved.
 #include <CoreMinimal.h>
 #include <AsyncFutures.h>
+#include "HAL/Event.h"
 
 BEGIN_DEFINE_SPEC(FAsyncFuturesSpec_TaskOptions, "AsyncFutures.TaskOptions", EAutomationTestFlags::ProductFilter | EAutomationTestFlags::EditorContext | EAutomationTestFlags::ServerContext)
 
+float PreviousAgingInterval = 0.0f;
+
 END_DEFINE_SPEC(FAsyncFuturesSpec_TaskOptions)
 
 
@@ -81,4 +84,129 @@ void FAsyncFuturesSpec_TaskOptions::Define()
 			Done.Execute();
 		},UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
 	});
+
+	LatentIt("Can run with every priority", [this](const auto& Done)
+	{
+		TArray<UE::Tasks::TAsyncFuture<bool>> Futures;
+		for (const UE::Tasks::EAsyncPriority Priority : { UE::Tasks::EAsyncPriority::Critical, UE::Tasks::EAsyncPriority::High, UE::Tasks::EAsyncPriority::Normal, UE::Tasks::EAsyncPriority::Background })
+		{
+			Futures.Add(UE::Tasks::Async([]()
+			{
+				return true;
+			}, UE::Tasks::FOptions().Set(Priority)));
+		}
+
+		UE::Tasks::WhenAll<bool>(Futures).Then([this, Done](const UE::Tasks::TResult<TArray<bool>>& Result)
+		{
+			TestTrue("Prioritised functions are completed", Result.HasValue());
+			TestEqual("Number of results", Result.GetValue().Num(), 4);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	Describe("Without aging", [this]()
+	{
+		BeforeEach([this]()
+		{
+			//Long enough that waiting work never catches up a level while the test runs
+			IConsoleVariable* AgingInterval = IConsoleManager::Get().FindConsoleVariable(TEXT("AsyncFutures.Priority.AgingInterval"));
+			PreviousAgingInterval = AgingInterval->GetFloat();
+			AgingInterval->Set(1000.0f);
+		});
+
+		AfterEach([this]()
+		{
+			IConsoleManager::Get().FindConsoleVariable(TEXT("AsyncFutures.Priority.AgingInterval"))->Set(PreviousAgingInterval);
+		});
+
+		LatentIt("Runs critical work ahead of queued background work", [this](const auto& Done)
+		{
+			//The game thread is held here while a worker queues all three for it, so no pump can start until all three are waiting
+			TSharedRef<TArray<UE::Tasks::EAsyncPriority>> Order = MakeShared<TArray<UE::Tasks::EAsyncPriority>>();
+			TArray<UE::Tasks::TAsyncFuture<void>> Futures;
+			FEvent* Queued = FPlatformProcess::GetSynchEventFromPool();
+			FFunctionGraphTask::CreateAndDispatchWhenReady([Order, &Futures, Queued]()
+			{
+				for (const UE::Tasks::EAsyncPriority Priority : { UE::Tasks::EAsyncPriority::Background, UE::Tasks::EAsyncPriority::Normal, UE::Tasks::EAsyncPriority::Critical })
+				{
+					Futures.Add(UE::Tasks::Async([Order, Priority]()
+					{
+						Order->Add(Priority);
+					}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread).Set(Priority)));
+				}
+				Queued->Trigger();
+			}, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask);
+			Queued->Wait();
+			FPlatformProcess::ReturnSynchEventToPool(Queued);
+
+			UE::Tasks::WhenAll(Futures).Then([this, Done, Order]()
+			{
+				TestEqual("Number of executions", Order->Num(), 3);
+				TestTrue("Critical work ran first", Order->Num() > 0 && (*Order)[0] == UE::Tasks::EAsyncPriority::Critical);
+				TestTrue("Background work ran last", Order->Num() == 3 && (*Order)[2] == UE::Tasks::EAsyncPriority::Background);
+				Done.Execute();
+			}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+		});
+	});
+
+	LatentIt("Doesn't start lazy work until it's started", [this](const auto& Done)
+	{
+		TSharedRef<std::atomic<int32>> Runs = MakeShared<std::atomic<int32>>(0);
+		UE::Tasks::TAsyncFuture<int32> Future = UE::Tasks::Async([Runs]()
+		{
+			return ++(Runs.Get());
+		}, UE::Tasks::FOptions().Set(UE::Tasks::EStartPolicy::Lazy));
+
+		UE::Tasks::WaitAsync(0.05f).Then([this, Done, Runs, Future]()
+		{
+			TestEqual("Lazy work hasn't run", Runs->load(), 0);
+			TestFalse("Lazy future isn't ready", Future.IsReady());
+
+			Future.Start();
+			Future.Then([this, Done, Runs](const int32 Value)
+			{
+				TestEqual("Lazy work ran once", Value, 1);
+				TestEqual("Number of runs", Runs->load(), 1);
+				Done.Execute();
+			}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Starts lazy work when a continuation is attached", [this](const auto& Done)
+	{
+		UE::Tasks::Async([]() { return 1; }, UE::Tasks::FOptions().Set(UE::Tasks::EStartPolicy::Lazy))
+		.Then([](const int32 Value) { return Value + 1; }, UE::Tasks::FOptions().Set(UE::Tasks::EStartPolicy::Lazy))
+		.Then([this, Done](const int32 Value)
+		{
+			TestEqual("Both lazy stages ran", Value, 2);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Never runs lazy work that's destroyed unobserved", [this](const auto& Done)
+	{
+		TSharedRef<std::atomic<int32>> Runs = MakeShared<std::atomic<int32>>(0);
+		{
+			UE::Tasks::TAsyncFuture<void> Future = UE::Tasks::Async([Runs]()
+			{
+				++(Runs.Get());
+			}, UE::Tasks::FOptions().Set(UE::Tasks::EStartPolicy::Lazy));
+		}
+
+		UE::Tasks::WaitAsync(0.05f).Then([this, Done, Runs]()
+		{
+			TestEqual("Lazy work never ran", Runs->load(), 0);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread));
+	});
+
+	LatentIt("Still runs work given a name and a stat", [this](const auto& Done)
+	{
+		UE::Tasks::Async([]() { return 1; }, UE::Tasks::FOptions().Set(TEXT("AsyncFutures.Test.Named")).Set(GET_STATID(STAT_TaskGraph_OtherTasks)))
+		.Then([this, Done](const int32 Value)
+		{
+			TestEqual("Named work ran", Value, 1);
+			Done.Execute();
+		}, UE::Tasks::FOptions().Set(ENamedThreads::GameThread).Set(TEXT("AsyncFutures.Test.NamedContinuation")));
+	});
 }